@@ -0,0 +1,10 @@
+#version 430
+
+in vec4 vertex_color;
+in vec2 vertex_tex_coord;
+
+out vec4 frag_color;
+
+void main() {
+  frag_color = vertex_color;
+}
@@ -1,11 +1,14 @@
-#version 420
+#version 430
 
-in vec4 frag_color;
-in vec2 frag_texCoords;
-out vec4 final;
-uniform sampler2D unif_texture;
+in vec4 vertex_color;
+in vec2 vertex_tex_coord;
 
-void main() {
-  final = texture(unif_texture, frag_texCoords);
-  // final = frag_color;
+out vec4 frag_color;
+
+uniform sampler2D u_texture;
+
+void main () {
+  vec4 color = texture(u_texture, vertex_tex_coord);
+  frag_color = color;
+  // frag_color = vec4(vertex_color);
 }
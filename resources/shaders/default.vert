@@ -1,17 +1,16 @@
-#version 420
+#version 430
 
-layout(location = 0) in vec2 vert_position;
-layout(location = 1) in vec3 vert_color;
-layout(location = 2) in vec2 vert_texCoords;
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec4 in_color;
+layout(location = 2) in vec2 in_tex_coord;
 
-out vec4 frag_color;
-out vec2 frag_texCoords;
+out vec4 vertex_color;
+out vec2 vertex_tex_coord;
+
+#include "camera.glsl"
 
 void main() {
-  // Set the position.
-  gl_Position = vec4(vert_position, 0.0, 1.0);
-  
-  // Forward the color and the texture coordinates.
-  frag_color = vec4(vert_color, 1.0);
-  frag_texCoords = vert_texCoords;
+  gl_Position = u_projection_matrix * u_view_matrix * vec4(in_position, 1.0);
+  vertex_color = in_color;
+  vertex_tex_coord = in_tex_coord;
 }
@@ -0,0 +1,36 @@
+#version 430
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec4 in_color;
+layout(location = 2) in vec2 in_tex_coord;
+// base_instance + gl_InstanceID, see IndirectRenderer.
+layout(location = 3) in uint in_instance;
+
+struct Instance {
+  mat4 transform;
+  uint material;
+  uint padding0;
+  uint padding1;
+  uint padding2;
+};
+
+layout(std430, binding = 0) readonly buffer Instances {
+  Instance instances[];
+};
+
+layout(std430, binding = 1) readonly buffer Materials {
+  vec4 material_colors[];
+};
+
+out vec4 vertex_color;
+out vec2 vertex_tex_coord;
+
+#include "camera.glsl"
+
+void main() {
+  Instance instance = instances[in_instance];
+  gl_Position =
+      u_projection_matrix * u_view_matrix * instance.transform * vec4(in_position, 1.0);
+  vertex_color = in_color * material_colors[instance.material];
+  vertex_tex_coord = in_tex_coord;
+}
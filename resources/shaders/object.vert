@@ -0,0 +1,18 @@
+#version 430
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec4 in_color;
+layout(location = 2) in vec2 in_tex_coord;
+
+out vec4 vertex_color;
+out vec2 vertex_tex_coord;
+
+#include "camera.glsl"
+
+uniform vec4 u_color;
+
+void main() {
+  gl_Position = u_projection_matrix * u_view_matrix * u_model_matrix * vec4(in_position, 1.0);
+  vertex_color = in_color * u_color;
+  vertex_tex_coord = in_tex_coord;
+}
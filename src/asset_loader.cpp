@@ -0,0 +1,169 @@
+#include "asset_loader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "gl_error.h"
+#include "profiler.h"
+
+AssetLoader::AssetLoader(size_t upload_budget_bytes, size_t worker_count)
+  : decode_pool_{worker_count}, upload_budget_bytes_{upload_budget_bytes} {}
+
+AssetLoader::~AssetLoader() {
+  destroy();
+}
+
+bool AssetLoader::init() {
+  glGenBuffers(GLsizei(kPixelBufferCount), pixel_buffers_);
+  for (GLuint buffer : pixel_buffers_) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(upload_budget_bytes_), nullptr,
+                 GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  GLError();
+
+  return true;
+}
+
+void AssetLoader::destroy() {
+  if (pixel_buffers_[0]) {
+    glDeleteBuffers(GLsizei(kPixelBufferCount), pixel_buffers_);
+    std::fill(std::begin(pixel_buffers_), std::end(pixel_buffers_), 0);
+  }
+}
+
+TextureFuture AssetLoader::load_texture(std::string path) {
+  auto state = std::make_shared<TextureLoadState>();
+  auto request = decode_pool_.submit(std::move(path));
+  decoding_.emplace(request.get(), state);
+  return TextureFuture{std::move(state)};
+}
+
+void AssetLoader::collect_decoded() {
+  completed_.clear();
+  decode_pool_.pop_completed(&completed_);
+
+  for (auto& request : completed_) {
+    auto it = decoding_.find(request.get());
+    if (it == decoding_.end()) {
+      continue;
+    }
+
+    auto state = std::move(it->second);
+    decoding_.erase(it);
+
+    if (request->state != DecodeRequest::State::kDecoded) {
+      state->state = TextureLoadState::State::kFailed;
+      continue;
+    }
+
+    uploads_.push_back({std::move(request), std::move(state), 0});
+  }
+}
+
+void AssetLoader::begin_texture(PendingUpload* upload) {
+  const Image& image = upload->decode->image;
+  Texture& texture = upload->state->texture;
+  texture.width = image.width;
+  texture.height = image.height;
+
+  glGenTextures(1, &texture.texture_id);
+  glBindTexture(GL_TEXTURE_2D, texture.texture_id);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, image.width, image.height);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  GLError();
+}
+
+void AssetLoader::process_uploads() {
+  PROFILE_ZONE("AssetLoader::process_uploads");
+  collect_decoded();
+
+  if (uploads_.empty()) {
+    return;
+  }
+
+  GLuint pixel_buffer = pixel_buffers_[next_pixel_buffer_];
+  next_pixel_buffer_ = (next_pixel_buffer_ + 1) % kPixelBufferCount;
+
+  // Invalidating the whole buffer lets the driver hand out fresh storage instead of waiting for
+  // uploads from previous frames that still read from it.
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+  auto* mapped = static_cast<uint8_t*>(
+      glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(upload_budget_bytes_),
+                       GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  GLError();
+  if (!mapped) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return;
+  }
+
+  copies_.clear();
+  size_t offset = 0;
+  size_t finished = 0;
+
+  for (auto& upload : uploads_) {
+    const Image& image = upload.decode->image;
+    const size_t row_bytes = size_t(image.width) * 4;
+
+    size_t rows_fit = (upload_budget_bytes_ - offset) / row_bytes;
+    if (rows_fit == 0) {
+      break;
+    }
+
+    if (upload.rows_uploaded == 0) {
+      begin_texture(&upload);
+    }
+
+    int rows = int(std::min(rows_fit, size_t(image.height - upload.rows_uploaded)));
+    std::memcpy(mapped + offset, image.pixels.data() + size_t(upload.rows_uploaded) * row_bytes,
+                size_t(rows) * row_bytes);
+    copies_.push_back(
+        {upload.state->texture.texture_id, upload.rows_uploaded, image.width, rows, offset});
+
+    offset += size_t(rows) * row_bytes;
+    upload.rows_uploaded += rows;
+
+    if (upload.rows_uploaded < image.height) {
+      break;
+    }
+    ++finished;
+  }
+
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  PROFILE_COUNT(kUploadBytes, offset);
+  PROFILE_COUNT(kTextureUploads, copies_.size());
+
+  for (const auto& copy : copies_) {
+    glBindTexture(GL_TEXTURE_2D, copy.texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, copy.y, copy.width, copy.rows, GL_RGBA,
+                    GL_UNSIGNED_BYTE, (void*)copy.offset);
+  }
+  GLError();
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  // Rows that are wider than the whole budget can never go through the pixel buffers, so upload
+  // them straight from client memory.
+  if (finished == 0 && copies_.empty()) {
+    auto& upload = uploads_.front();
+    const Image& image = upload.decode->image;
+    std::cerr << "Image " << upload.decode->path << " exceeds the upload budget.\n";
+    begin_texture(&upload);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width, image.height, GL_RGBA, GL_UNSIGNED_BYTE,
+                    image.pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GLError();
+    PROFILE_COUNT(kTextureUploads, 1);
+    PROFILE_COUNT(kUploadBytes, image.pixels.size());
+    finished = 1;
+  }
+
+  for (size_t i = 0; i < finished; ++i) {
+    uploads_.front().state->state = TextureLoadState::State::kResident;
+    uploads_.pop_front();
+  }
+}
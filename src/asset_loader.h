@@ -0,0 +1,111 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "image_decode_pool.h"
+#include "texture.h"
+
+struct TextureLoadState {
+  enum class State {
+    kLoading,
+    kResident,
+    kFailed,
+  };
+
+  std::atomic<State> state{State::kLoading};
+  Texture texture{};
+};
+
+// Handle to a texture that is being loaded by the `AssetLoader`.
+class TextureFuture {
+public:
+  TextureFuture() = default;
+
+  bool valid() const {
+    return state_ != nullptr;
+  }
+
+  bool is_resident() const {
+    return state_ && state_->state == TextureLoadState::State::kResident;
+  }
+
+  bool failed() const {
+    return state_ && state_->state == TextureLoadState::State::kFailed;
+  }
+
+  // Only meaningful once `is_resident` returns true.
+  const Texture& texture() const {
+    return state_->texture;
+  }
+
+private:
+  friend class AssetLoader;
+
+  explicit TextureFuture(std::shared_ptr<TextureLoadState> state) : state_{std::move(state)} {}
+
+  std::shared_ptr<TextureLoadState> state_;
+};
+
+// Loads textures without blocking the main thread.  Images are decoded on the workers of an
+// `ImageDecodePool`.  `process_uploads`, called once per frame on the thread that owns the GL
+// context, streams decoded pixels through pixel buffer objects, uploading at most
+// `upload_budget_bytes` per frame.  Large images are split over several frames by rows.
+class AssetLoader {
+public:
+  static constexpr size_t kPixelBufferCount = 3;
+
+  explicit AssetLoader(size_t upload_budget_bytes = 8 * 1024 * 1024, size_t worker_count = 0);
+  ~AssetLoader();
+
+  AssetLoader(const AssetLoader&) = delete;
+  AssetLoader& operator=(const AssetLoader&) = delete;
+
+  // Creates the pixel buffers.  Requires a current GL context.
+  bool init();
+  void destroy();
+
+  TextureFuture load_texture(std::string path);
+
+  void process_uploads();
+
+  // True when no texture is being decoded or uploaded.
+  bool idle() const {
+    return decoding_.empty() && uploads_.empty();
+  }
+
+private:
+  struct PendingUpload {
+    std::shared_ptr<DecodeRequest> decode;
+    std::shared_ptr<TextureLoadState> state;
+    int rows_uploaded = 0;
+  };
+
+  struct RowCopy {
+    GLuint texture;
+    int y;
+    int width;
+    int rows;
+    size_t offset;
+  };
+
+  void collect_decoded();
+  void begin_texture(PendingUpload* upload);
+
+  ImageDecodePool decode_pool_;
+  size_t upload_budget_bytes_;
+
+  std::unordered_map<DecodeRequest*, std::shared_ptr<TextureLoadState>> decoding_;
+  std::vector<std::shared_ptr<DecodeRequest>> completed_;
+  std::deque<PendingUpload> uploads_;
+  std::vector<RowCopy> copies_;
+
+  GLuint pixel_buffers_[kPixelBufferCount] = {};
+  size_t next_pixel_buffer_ = 0;
+};
@@ -0,0 +1,108 @@
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "hash.h"
+
+namespace {
+
+// An image entry must describe a mip chain no longer than a full one, and its data must be exactly
+// that chain, since `load_texture` walks it level by level.
+bool valid_image(const AssetPackEntry& entry) {
+  // Bounding the size keeps the sum of the levels far from wrapping around.
+  if (entry.width == 0 || entry.height == 0 || entry.width > kAssetPackMaxImageSize ||
+      entry.height > kAssetPackMaxImageSize || entry.mip_count == 0 ||
+      entry.mip_count > full_mip_count(entry.width, entry.height)) {
+    return false;
+  }
+
+  uint64_t size = 0;
+  for (uint32_t level = 0; level < entry.mip_count; ++level) {
+    size += mip_level_size(entry.width, entry.height, level);
+  }
+  return entry.data_size == size;
+}
+
+}  // namespace
+
+bool AssetPack::open(const std::string& path) {
+  close();
+
+  if (!file_.open(path)) {
+    return false;
+  }
+
+  if (file_.size() < sizeof(AssetPackHeader)) {
+    std::cerr << "Asset pack " << path << " is truncated.\n";
+    file_.close();
+    return false;
+  }
+
+  auto* header = reinterpret_cast<const AssetPackHeader*>(file_.data());
+  if (header->magic != kAssetPackMagic || header->version != kAssetPackVersion) {
+    std::cerr << "Asset pack " << path << " has an unsupported format.\n";
+    file_.close();
+    return false;
+  }
+
+  // Range checks subtract from the file size so offsets near 2^64 cannot wrap around.
+  if (header->index_offset > file_.size() ||
+      uint64_t(header->entry_count) * sizeof(AssetPackEntry) >
+          file_.size() - header->index_offset ||
+      header->strings_offset > header->index_offset) {
+    std::cerr << "Asset pack " << path << " is corrupt.\n";
+    file_.close();
+    return false;
+  }
+
+  auto* entries = reinterpret_cast<const AssetPackEntry*>(file_.data() + header->index_offset);
+  for (uint32_t i = 0; i < header->entry_count; ++i) {
+    const AssetPackEntry& entry = entries[i];
+    if (entry.data_offset > header->strings_offset ||
+        entry.data_size > header->strings_offset - entry.data_offset ||
+        uint64_t(entry.name_offset) + entry.name_length >
+            header->index_offset - header->strings_offset ||
+        (entry.type == AssetType::kImage && !valid_image(entry))) {
+      std::cerr << "Asset pack " << path << " is corrupt.\n";
+      file_.close();
+      return false;
+    }
+  }
+
+  header_ = header;
+  entries_ = entries;
+
+  return true;
+}
+
+void AssetPack::close() {
+  file_.close();
+  header_ = nullptr;
+  entries_ = nullptr;
+}
+
+const AssetPackEntry* AssetPack::find(std::string_view name) const {
+  if (!header_) {
+    return nullptr;
+  }
+
+  uint64_t hash = fnv1a_64(name);
+  auto* first = std::lower_bound(begin(), end(), hash,
+                                 [](const AssetPackEntry& entry, uint64_t h) {
+                                   return entry.name_hash < h;
+                                 });
+
+  for (auto* entry = first; entry != end() && entry->name_hash == hash; ++entry) {
+    if (this->name(*entry) == name) {
+      return entry;
+    }
+  }
+
+  return nullptr;
+}
+
+std::string_view AssetPack::name(const AssetPackEntry& entry) const {
+  auto* strings = reinterpret_cast<const char*>(file_.data() + header_->strings_offset);
+  return {strings + entry.name_offset, entry.name_length};
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "mapped_file.h"
+
+// Binary asset pack produced by the asset cooker (src/tools/asset_cooker.cpp).
+//
+// Layout (native endianness):
+//   AssetPackHeader
+//   asset data, every blob aligned to kAssetPackAlignment
+//   string table holding the asset names
+//   AssetPackEntry[entry_count], sorted by name_hash
+//
+// Images are stored as pre-decoded RGBA8 mip chains, largest level first.  Shaders and vertex
+// blobs are stored as-is.
+
+constexpr uint32_t kAssetPackMagic = 0x4b504743;  // "CGPK"
+constexpr uint32_t kAssetPackVersion = 1;
+constexpr size_t kAssetPackAlignment = 16;
+// Largest width or height of a cooked image.
+constexpr uint32_t kAssetPackMaxImageSize = 16384;
+
+enum class AssetType : uint32_t {
+  kImage = 1,
+  kVertices = 2,
+  kShader = 3,
+};
+
+struct AssetPackHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+  uint64_t index_offset;
+  uint64_t strings_offset;
+};
+
+struct AssetPackEntry {
+  uint64_t name_hash;
+  // Hash of the source file the asset was cooked from.
+  uint64_t content_hash;
+  uint64_t data_offset;
+  uint64_t data_size;
+  AssetType type;
+  uint32_t name_offset;
+  uint32_t name_length;
+  // Only used by images.
+  uint32_t width;
+  uint32_t height;
+  uint32_t mip_count;
+  uint32_t reserved[2];
+};
+
+static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader layout changed");
+static_assert(sizeof(AssetPackEntry) == 64, "AssetPackEntry layout changed");
+
+// Size in bytes of mip level `level` of a `width` x `height` RGBA8 image.
+inline size_t mip_level_size(uint32_t width, uint32_t height, uint32_t level) {
+  uint32_t w = width >> level;
+  uint32_t h = height >> level;
+  return size_t(w ? w : 1) * size_t(h ? h : 1) * 4;
+}
+
+// Number of levels in a full mip chain down to 1x1.
+inline uint32_t full_mip_count(uint32_t width, uint32_t height) {
+  uint32_t count = 1;
+  while (((width > height ? width : height) >> count) != 0) {
+    ++count;
+  }
+  return count;
+}
+
+// A memory mapped asset pack.  Asset data is read straight from the mapping; nothing is copied.
+class AssetPack {
+public:
+  bool open(const std::string& path);
+  void close();
+
+  bool is_open() const {
+    return header_ != nullptr;
+  }
+
+  // Looks up an asset by its name relative to the resources directory, e.g. "block_test.png".
+  const AssetPackEntry* find(std::string_view name) const;
+
+  const uint8_t* data(const AssetPackEntry& entry) const {
+    return file_.data() + entry.data_offset;
+  }
+
+  std::string_view name(const AssetPackEntry& entry) const;
+
+  const AssetPackEntry* begin() const {
+    return entries_;
+  }
+
+  const AssetPackEntry* end() const {
+    return header_ ? entries_ + header_->entry_count : nullptr;
+  }
+
+private:
+  MappedFile file_;
+  const AssetPackHeader* header_ = nullptr;
+  const AssetPackEntry* entries_ = nullptr;
+};
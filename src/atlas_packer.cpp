@@ -0,0 +1,146 @@
+#include "atlas_packer.h"
+
+#include <algorithm>
+#include <climits>
+#include <numeric>
+
+SkylinePacker::SkylinePacker(int width, int height) : width_{width}, height_{height} {
+  skyline_.push_back({0, 0, width});
+}
+
+int SkylinePacker::fit(size_t index, int width, int height) const {
+  int x = skyline_[index].x;
+  if (x + width > width_) {
+    return -1;
+  }
+
+  int y = 0;
+  int remaining = width;
+  for (size_t i = index; remaining > 0; ++i) {
+    y = std::max(y, skyline_[i].y);
+    if (y + height > height_) {
+      return -1;
+    }
+    remaining -= skyline_[i].width;
+  }
+
+  return y;
+}
+
+bool SkylinePacker::pack(int width, int height, AtlasRect* out) {
+  int best_bottom = INT_MAX;
+  int best_width = INT_MAX;
+  size_t best_index = skyline_.size();
+  int best_y = 0;
+
+  for (size_t i = 0; i < skyline_.size(); ++i) {
+    int y = fit(i, width, height);
+    if (y < 0) {
+      continue;
+    }
+
+    int bottom = y + height;
+    if (bottom < best_bottom || (bottom == best_bottom && skyline_[i].width < best_width)) {
+      best_bottom = bottom;
+      best_width = skyline_[i].width;
+      best_index = i;
+      best_y = y;
+    }
+  }
+
+  if (best_index == skyline_.size()) {
+    return false;
+  }
+
+  *out = {skyline_[best_index].x, best_y, width, height};
+
+  // Insert the new top edge and trim the nodes it now covers.
+  skyline_.insert(skyline_.begin() + best_index, {out->x, best_y + height, width});
+
+  for (size_t i = best_index + 1; i < skyline_.size();) {
+    Node& previous = skyline_[i - 1];
+    Node& node = skyline_[i];
+    int previous_end = previous.x + previous.width;
+    if (node.x >= previous_end) {
+      break;
+    }
+
+    int shrink = previous_end - node.x;
+    node.x += shrink;
+    node.width -= shrink;
+    if (node.width > 0) {
+      break;
+    }
+    skyline_.erase(skyline_.begin() + i);
+  }
+
+  // Merge neighbours at the same height.
+  for (size_t i = 0; i + 1 < skyline_.size();) {
+    if (skyline_[i].y == skyline_[i + 1].y) {
+      skyline_[i].width += skyline_[i + 1].width;
+      skyline_.erase(skyline_.begin() + i + 1);
+    } else {
+      ++i;
+    }
+  }
+
+  used_area_ += size_t(width) * size_t(height);
+
+  return true;
+}
+
+AtlasPackResult pack_atlas(const std::vector<AtlasRect>& sizes, int page_width, int page_height,
+                           int padding) {
+  AtlasPackResult result;
+  result.placements.resize(sizes.size());
+
+  // Packing tall rectangles first gives a flatter skyline.
+  std::vector<size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) {
+    if (sizes[a].height != sizes[b].height) {
+      return sizes[a].height > sizes[b].height;
+    }
+    return sizes[a].width > sizes[b].width;
+  });
+
+  std::vector<SkylinePacker> pages;
+  size_t image_area = 0;
+
+  for (size_t index : order) {
+    int width = sizes[index].width + padding * 2;
+    int height = sizes[index].height + padding * 2;
+    if (width > page_width || height > page_height) {
+      continue;
+    }
+
+    AtlasRect rect;
+    int page = -1;
+    for (size_t i = 0; i < pages.size(); ++i) {
+      if (pages[i].pack(width, height, &rect)) {
+        page = int(i);
+        break;
+      }
+    }
+
+    if (page < 0) {
+      pages.emplace_back(page_width, page_height);
+      pages.back().pack(width, height, &rect);
+      page = int(pages.size() - 1);
+    }
+
+    AtlasPlacement& placement = result.placements[index];
+    placement.page = page;
+    placement.rect = {rect.x + padding, rect.y + padding, sizes[index].width,
+                      sizes[index].height};
+    image_area += size_t(sizes[index].width) * size_t(sizes[index].height);
+  }
+
+  result.page_count = int(pages.size());
+  if (!pages.empty()) {
+    result.efficiency =
+        double(image_area) / (double(page_width) * double(page_height) * double(pages.size()));
+  }
+
+  return result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct AtlasRect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+};
+
+// Packs rectangles into a single fixed size page using the skyline bottom-left heuristic.
+class SkylinePacker {
+public:
+  SkylinePacker(int width, int height);
+
+  // Finds space for a `width` x `height` rectangle.  Returns false if the page is full.
+  bool pack(int width, int height, AtlasRect* out);
+
+  // Area of all rectangles packed so far.
+  size_t used_area() const {
+    return used_area_;
+  }
+
+  int width() const {
+    return width_;
+  }
+
+  int height() const {
+    return height_;
+  }
+
+private:
+  struct Node {
+    int x;
+    int y;
+    int width;
+  };
+
+  // Returns the lowest y at which a rectangle of `width` fits when its left edge is at node
+  // `index`, or -1 if it does not fit.
+  int fit(size_t index, int width, int height) const;
+
+  int width_;
+  int height_;
+  size_t used_area_ = 0;
+  std::vector<Node> skyline_;
+};
+
+struct AtlasPlacement {
+  int page = -1;
+  // Position of the image itself, excluding the padding around it.
+  AtlasRect rect;
+};
+
+struct AtlasPackResult {
+  std::vector<AtlasPlacement> placements;
+  int page_count = 0;
+  // Fraction of the allocated page area that is covered by images (excluding padding).
+  double efficiency = 0.0;
+};
+
+// Packs `sizes` (width, height pairs) into as many `page_width` x `page_height` pages as needed.
+// Each rectangle is surrounded by `padding` texels on every side so bilinear filtering of the base
+// level does not pick up its neighbours.  Mipmapped atlases need the gutter to be at least
+// `1 << (levels - 1)` texels wide and filled with the image's edge texels.  Rectangles that can
+// never fit in a page are left with `page == -1`.  Placements are returned in the same order as
+// `sizes`.
+AtlasPackResult pack_atlas(const std::vector<AtlasRect>& sizes, int page_width, int page_height,
+                           int padding);
@@ -0,0 +1,125 @@
+#include "batch_renderer.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "gl_error.h"
+#include "mesh.h"
+#include "profiler.h"
+
+BatchRenderer::~BatchRenderer() {
+  destroy();
+}
+
+bool BatchRenderer::init(size_t max_quads_per_flush) {
+  quads_per_region_ = max_quads_per_flush;
+
+  const size_t region_vertices = quads_per_region_ * QuadBatch::kVerticesPerQuad;
+
+  glGenVertexArrays(1, &vertex_array_object_);
+  glBindVertexArray(vertex_array_object_);
+
+  // Create the streaming vertex buffer.
+  if (!vertices_.init(GL_ARRAY_BUFFER, region_vertices * sizeof(Vertex))) {
+    std::cerr << "Could not create batch vertex buffer.\n";
+    glBindVertexArray(0);
+    return false;
+  }
+
+  set_vertex_attributes();
+
+  // The index pattern is the same for every region, so it is uploaded once and offset with a base
+  // vertex at draw time.
+  std::vector<uint32_t> indices(quads_per_region_ * QuadBatch::kIndicesPerQuad);
+  QuadBatch::generate_indices(indices.data(), quads_per_region_);
+
+  glGenBuffers(1, &index_buffer_);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(uint32_t)),
+               indices.data(), GL_STATIC_DRAW);
+  GLError();
+
+  glBindVertexArray(0);
+
+  return true;
+}
+
+void BatchRenderer::destroy() {
+  vertices_.destroy();
+
+  if (index_buffer_) {
+    glDeleteBuffers(1, &index_buffer_);
+    index_buffer_ = 0;
+  }
+
+  if (vertex_array_object_) {
+    glDeleteVertexArrays(1, &vertex_array_object_);
+    vertex_array_object_ = 0;
+  }
+}
+
+void BatchRenderer::flush() {
+  PROFILE_ZONE("BatchRenderer::flush");
+  PROFILE_GPU_ZONE("BatchRenderer::flush");
+
+  stats_ = {};
+  stats_.quads = batch_.quad_count();
+
+  if (batch_.quad_count() == 0) {
+    return;
+  }
+
+  batch_.sort();
+
+  glBindVertexArray(vertex_array_object_);
+  GLError();
+
+  GLuint bound_program = 0;
+  GLuint bound_texture = 0;
+  bool first_command = true;
+
+  for (size_t first = 0; first < batch_.quad_count();) {
+    vertices_.begin_region();
+
+    // A region holds `quads_per_region_` quads, so this cannot fail.
+    size_t quads = std::min(quads_per_region_, batch_.quad_count() - first);
+    GLintptr offset = 0;
+    Vertex* vertices = vertices_.allocate<Vertex>(quads * QuadBatch::kVerticesPerQuad, &offset);
+
+    commands_.clear();
+    size_t written = batch_.build(first, quads, vertices, &commands_);
+    first += written;
+
+    vertices_.flush_writes();
+    const auto base_vertex = GLint(offset / GLintptr(sizeof(Vertex)));
+
+    for (const auto& command : commands_) {
+      if (first_command || command.program != bound_program) {
+        glUseProgram(command.program);
+        bound_program = command.program;
+        ++stats_.program_changes;
+      }
+
+      if (first_command || command.texture != bound_texture) {
+        glBindTexture(GL_TEXTURE_2D, command.texture);
+        bound_texture = command.texture;
+        ++stats_.texture_changes;
+      }
+      first_command = false;
+
+      glDrawElementsBaseVertex(GL_TRIANGLES, GLsizei(command.index_count), GL_UNSIGNED_INT,
+                               (void*)(command.first_index * sizeof(uint32_t)), base_vertex);
+      GLError();
+      ++stats_.draw_calls;
+    }
+
+    vertices_.end_region();
+  }
+
+  glBindVertexArray(0);
+
+  PROFILE_COUNT(kDrawCalls, stats_.draw_calls);
+  PROFILE_COUNT(kStateChanges, 1 + stats_.program_changes + stats_.texture_changes);
+
+  batch_.clear();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+#include "dynamic_buffer.h"
+#include "quad_batch.h"
+
+struct BatchStats {
+  size_t quads = 0;
+  size_t draw_calls = 0;
+  size_t program_changes = 0;
+  size_t texture_changes = 0;
+};
+
+// Draws large numbers of textured quads with a handful of indexed draw calls.
+//
+// Vertices are written straight into a `DynamicBufferRing`, one region per batch of
+// `max_quads_per_flush` quads.  Indices follow a fixed pattern and live in a static buffer.
+class BatchRenderer {
+public:
+  BatchRenderer() = default;
+  ~BatchRenderer();
+
+  BatchRenderer(const BatchRenderer&) = delete;
+  BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+  // `max_quads_per_flush` is the size of one region.  Frames with more quads are split over
+  // several regions.
+  bool init(size_t max_quads_per_flush);
+  void destroy();
+
+  void submit(GLuint program, GLuint texture, const Quad& quad) {
+    batch_.submit(program, texture, quad);
+  }
+
+  // Sorts and draws everything submitted since the last flush.  The caller is responsible for
+  // setting up uniforms on the programs used.
+  void flush();
+
+  const BatchStats& last_stats() const {
+    return stats_;
+  }
+
+private:
+  QuadBatch batch_;
+  std::vector<BatchDrawCommand> commands_;
+  BatchStats stats_;
+
+  size_t quads_per_region_ = 0;
+  GLuint vertex_array_object_ = 0;
+  GLuint index_buffer_ = 0;
+  DynamicBufferRing vertices_;
+};
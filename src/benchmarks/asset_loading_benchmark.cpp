@@ -0,0 +1,60 @@
+// Compares startup time for decoding N images serially on one thread against decoding them on the
+// asset loader's decode pool.  GL uploads are not part of the measurement, so no context is needed.
+//
+// Usage: asset-loading-benchmark <image> [count] [workers]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "image.h"
+#include "image_decode_pool.h"
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: asset-loading-benchmark <image> [count] [workers]\n";
+    return 1;
+  }
+
+  std::string path = argv[1];
+  size_t count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+  size_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+
+  auto start = std::chrono::steady_clock::now();
+  size_t failed = 0;
+  for (size_t i = 0; i < count; ++i) {
+    Image image;
+    if (!load_image(path, &image)) {
+      ++failed;
+    }
+  }
+  std::chrono::duration<double> serial = std::chrono::steady_clock::now() - start;
+
+  ImageDecodePool pool{workers};
+  std::vector<std::shared_ptr<DecodeRequest>> requests;
+  requests.reserve(count);
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < count; ++i) {
+    requests.push_back(pool.submit(path));
+  }
+  pool.wait_idle();
+  std::chrono::duration<double> parallel = std::chrono::steady_clock::now() - start;
+
+  for (const auto& request : requests) {
+    if (request->state != DecodeRequest::State::kDecoded) {
+      ++failed;
+    }
+  }
+
+  std::cout << "images:        " << count << '\n';
+  std::cout << "workers:       " << pool.worker_count() << '\n';
+  std::cout << "serial ms:     " << serial.count() * 1000.0 << '\n';
+  std::cout << "parallel ms:   " << parallel.count() * 1000.0 << '\n';
+  std::cout << "speedup:       " << serial.count() / parallel.count() << '\n';
+  std::cout << "failed:        " << failed << '\n';
+
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// Compares getting texel data for every image in a cooked asset pack against decoding the source
+// images with stb_image, which is what `load_texture` does before uploading.  The cold pass asks
+// the OS to drop the files from the page cache first (Linux only, best effort); the warm pass runs
+// with everything cached.
+//
+// Usage: asset-pack-benchmark <pack> <resources_dir> [warm_runs]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "asset_pack.h"
+#include "image.h"
+
+namespace {
+
+void drop_page_cache(const std::string& path) {
+#if defined(__linux__)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+  }
+#else
+  (void)path;
+#endif
+}
+
+// Reads every byte so the pages are actually faulted in, like an upload would.
+uint64_t touch(const uint8_t* data, size_t size) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < size; i += 64) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+double load_from_pack(const std::string& pack_path, const std::vector<std::string>& names,
+                      uint64_t* checksum) {
+  auto start = std::chrono::steady_clock::now();
+
+  AssetPack pack;
+  if (!pack.open(pack_path)) {
+    return 0.0;
+  }
+  for (const auto& name : names) {
+    const AssetPackEntry* entry = pack.find(name);
+    *checksum += touch(pack.data(*entry), size_t(entry->data_size));
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+double load_from_sources(const std::string& resources_dir, const std::vector<std::string>& names,
+                         uint64_t* checksum) {
+  auto start = std::chrono::steady_clock::now();
+
+  for (const auto& name : names) {
+    Image image;
+    if (load_image(resources_dir + "/" + name, &image)) {
+      *checksum += touch(image.pixels.data(), image.pixels.size());
+    }
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: asset-pack-benchmark <pack> <resources_dir> [warm_runs]\n";
+    return 1;
+  }
+
+  std::string pack_path = argv[1];
+  std::string resources_dir = argv[2];
+  size_t warm_runs = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 20;
+
+  std::vector<std::string> names;
+  {
+    AssetPack pack;
+    if (!pack.open(pack_path)) {
+      std::cerr << "Could not open " << pack_path << ".\n";
+      return 1;
+    }
+    for (const auto& entry : pack) {
+      if (entry.type == AssetType::kImage) {
+        names.emplace_back(pack.name(entry));
+      }
+    }
+  }
+
+  uint64_t checksum = 0;
+
+  drop_page_cache(pack_path);
+  for (const auto& name : names) {
+    drop_page_cache(resources_dir + "/" + name);
+  }
+  double pack_cold = load_from_pack(pack_path, names, &checksum);
+  double sources_cold = load_from_sources(resources_dir, names, &checksum);
+
+  double pack_warm = 0.0;
+  double sources_warm = 0.0;
+  for (size_t run = 0; run < warm_runs; ++run) {
+    pack_warm += load_from_pack(pack_path, names, &checksum);
+    sources_warm += load_from_sources(resources_dir, names, &checksum);
+  }
+  pack_warm /= double(warm_runs);
+  sources_warm /= double(warm_runs);
+
+  std::cout << "images:             " << names.size() << '\n';
+  std::cout << "pack cold ms:       " << pack_cold * 1000.0 << '\n';
+  std::cout << "stb_image cold ms:  " << sources_cold * 1000.0 << '\n';
+  std::cout << "pack warm ms:       " << pack_warm * 1000.0 << '\n';
+  std::cout << "stb_image warm ms:  " << sources_warm * 1000.0 << '\n';
+  std::cout << "checksum:           " << checksum << '\n';
+
+  return 0;
+}
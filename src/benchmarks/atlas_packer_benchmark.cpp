@@ -0,0 +1,71 @@
+// Measures packing time and packing efficiency of the atlas packer over many random rectangles.
+//
+// Usage: atlas-packer-benchmark [rect_count] [page_size] [padding] [runs]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "atlas_packer.h"
+
+namespace {
+
+bool overlaps(const AtlasPlacement& a, const AtlasPlacement& b) {
+  return a.page == b.page && a.rect.x < b.rect.x + b.rect.width &&
+         b.rect.x < a.rect.x + a.rect.width && a.rect.y < b.rect.y + b.rect.height &&
+         b.rect.y < a.rect.y + a.rect.height;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t rect_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+  int page_size = argc > 2 ? std::atoi(argv[2]) : 2048;
+  int padding = argc > 3 ? std::atoi(argv[3]) : 2;
+  size_t runs = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 20;
+
+  std::mt19937 rng{1234};
+  std::uniform_int_distribution<int> dimension{8, 96};
+
+  std::vector<AtlasRect> sizes(rect_count);
+  for (auto& size : sizes) {
+    size.width = dimension(rng);
+    size.height = dimension(rng);
+  }
+
+  AtlasPackResult result;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t run = 0; run < runs; ++run) {
+    result = pack_atlas(sizes, page_size, page_size, padding);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  size_t unplaced = 0;
+  size_t overlapping = 0;
+  for (size_t i = 0; i < result.placements.size(); ++i) {
+    if (result.placements[i].page < 0) {
+      ++unplaced;
+      continue;
+    }
+    for (size_t j = i + 1; j < result.placements.size(); ++j) {
+      if (overlaps(result.placements[i], result.placements[j])) {
+        ++overlapping;
+      }
+    }
+  }
+
+  double ms = elapsed.count() * 1000.0 / double(runs);
+  std::cout << "rects:          " << rect_count << '\n';
+  std::cout << "page size:      " << page_size << 'x' << page_size << '\n';
+  std::cout << "padding:        " << padding << '\n';
+  std::cout << "pages:          " << result.page_count << '\n';
+  std::cout << "efficiency:     " << result.efficiency * 100.0 << "%\n";
+  std::cout << "ms/pack:        " << ms << '\n';
+  std::cout << "us/rect:        " << ms * 1000.0 / double(rect_count) << '\n';
+  std::cout << "unplaced:       " << unplaced << '\n';
+  std::cout << "overlaps:       " << overlapping << '\n';
+
+  return overlapping == 0 ? 0 : 1;
+}
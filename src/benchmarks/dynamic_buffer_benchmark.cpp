@@ -0,0 +1,222 @@
+// Compares ways of streaming per-frame vertex data: re-specifying the buffer with glBufferData,
+// orphaning it and then filling it with glBufferSubData, plain glBufferSubData into the buffer the
+// previous frame drew from, and the persistently mapped `DynamicBufferRing`.  Every frame uploads
+// the same amount of vertex data and draws it as points, so the GPU really reads what was written.
+//
+// Reports sustained upload throughput (MB/s, including the final glFinish), CPU time spent in the
+// upload path per frame, and for the ring, the part of it spent waiting on fences.  Runs on a
+// headless EGL context, so it also works on machines without a display.
+//
+// Usage: dynamic-buffer-benchmark [mb_per_frame] [frames]
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "dynamic_buffer.h"
+#include "gl_error.h"
+#include "headless_context.h"
+#include "mesh.h"
+#include "render_target.h"
+
+namespace {
+
+constexpr char kVertexShader[] = R"(#version 430 core
+layout(location = 0) in vec3 in_position;
+void main() {
+  gl_Position = vec4(in_position, 1.0);
+}
+)";
+
+constexpr char kFragmentShader[] = R"(#version 430 core
+out vec4 out_color;
+void main() {
+  out_color = vec4(1.0);
+}
+)";
+
+GLuint create_program() {
+  auto compile = [](GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    return shader;
+  };
+
+  GLuint vertex_shader = compile(GL_VERTEX_SHADER, kVertexShader);
+  GLuint fragment_shader = compile(GL_FRAGMENT_SHADER, kFragmentShader);
+
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glLinkProgram(program);
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+
+  GLint linked = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &linked);
+  if (!linked) {
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  return program;
+}
+
+struct Result {
+  const char* name;
+  double total_ms = 0.0;
+  double upload_ms = 0.0;
+  double stall_ms = 0.0;
+};
+
+// Runs `frames` frames.  `upload` streams the vertices and returns the first vertex to draw from;
+// `after_draw` runs once the draw reading them has been issued.
+template <typename Upload, typename AfterDraw>
+Result run(const char* name, size_t frames, size_t vertex_count, Upload upload,
+           AfterDraw after_draw) {
+  Result result{name};
+
+  // Warm up so buffer allocation is not measured.
+  upload();
+  after_draw();
+  glFinish();
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t frame = 0; frame < frames; ++frame) {
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    auto upload_start = std::chrono::steady_clock::now();
+    GLint first = upload();
+    std::chrono::duration<double, std::milli> upload_time =
+        std::chrono::steady_clock::now() - upload_start;
+    result.upload_ms += upload_time.count();
+
+    glDrawArrays(GL_POINTS, first, GLsizei(vertex_count));
+    after_draw();
+    glFlush();
+  }
+  glFinish();
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  result.total_ms = elapsed.count();
+
+  return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  double mb_per_frame = argc > 1 ? std::atof(argv[1]) : 4.0;
+  size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200;
+
+  HeadlessContext context;
+  if (!context.init(4, 3)) {
+    return 1;
+  }
+
+  if (!init_glew(true)) {
+    std::cerr << "Could not initialize GLEW.\n";
+    return 1;
+  }
+
+  RenderTarget target;
+  if (!target.init(256, 256)) {
+    return 1;
+  }
+  target.bind();
+
+  GLuint program = create_program();
+  if (!program) {
+    std::cerr << "Could not create program.\n";
+    return 1;
+  }
+  glUseProgram(program);
+
+  const auto vertex_count = size_t(mb_per_frame * 1024.0 * 1024.0) / sizeof(Vertex);
+  const size_t frame_bytes = vertex_count * sizeof(Vertex);
+
+  std::vector<Vertex> source(vertex_count);
+  for (size_t i = 0; i < vertex_count; ++i) {
+    float x = float(i % 1024) / 512.0f - 1.0f;
+    float y = float(i / 1024 % 1024) / 512.0f - 1.0f;
+    source[i] = {{x, y, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}};
+  }
+
+  // Classic streaming buffer for the glBufferData / glBufferSubData paths.
+  GLuint vertex_array_object = 0;
+  GLuint buffer = 0;
+  glGenVertexArrays(1, &vertex_array_object);
+  glBindVertexArray(vertex_array_object);
+  glGenBuffers(1, &buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(frame_bytes), nullptr, GL_STREAM_DRAW);
+  set_vertex_attributes();
+
+  std::vector<Result> results;
+
+  results.push_back(run("glBufferData", frames, vertex_count, [&]() {
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(frame_bytes), source.data(), GL_STREAM_DRAW);
+    return 0;
+  }, []() {}));
+
+  results.push_back(run("orphan + glBufferSubData", frames, vertex_count, [&]() {
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(frame_bytes), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(frame_bytes), source.data());
+    return 0;
+  }, []() {}));
+
+  results.push_back(run("glBufferSubData", frames, vertex_count, [&]() {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(frame_bytes), source.data());
+    return 0;
+  }, []() {}));
+
+  // Persistently mapped ring, written in place.
+  GLuint ring_vertex_array_object = 0;
+  glGenVertexArrays(1, &ring_vertex_array_object);
+  glBindVertexArray(ring_vertex_array_object);
+  DynamicBufferRing ring;
+  if (!ring.init(GL_ARRAY_BUFFER, frame_bytes)) {
+    return 1;
+  }
+  set_vertex_attributes();
+
+  Result ring_result = run("persistent ring", frames, vertex_count, [&]() {
+    ring.begin_region();
+    GLintptr offset = 0;
+    Vertex* vertices = ring.allocate<Vertex>(vertex_count, &offset);
+    std::memcpy(static_cast<void*>(vertices), source.data(), frame_bytes);
+    ring.flush_writes();
+    return GLint(offset / GLintptr(sizeof(Vertex)));
+  }, [&]() { ring.end_region(); });
+  ring_result.stall_ms = ring.stall_ms();
+  if (!ring.persistent()) {
+    ring_result.name = "ring (no buffer storage)";
+  }
+  results.push_back(ring_result);
+
+  std::cout << "MB/frame: " << mb_per_frame << ", frames: " << frames << '\n';
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "path                           MB/s   upload ms/frame   stall ms/frame\n";
+  for (const auto& result : results) {
+    double mb_per_second = double(frame_bytes * frames) / (1024.0 * 1024.0) /
+                           (result.total_ms / 1000.0);
+    std::cout << std::left << std::setw(26) << result.name << std::right << std::setw(10)
+              << mb_per_second << std::setw(18) << result.upload_ms / double(frames)
+              << std::setw(17) << result.stall_ms / double(frames) << '\n';
+  }
+
+  ring.destroy();
+  glDeleteBuffers(1, &buffer);
+  glDeleteVertexArrays(1, &vertex_array_object);
+  glDeleteVertexArrays(1, &ring_vertex_array_object);
+  glDeleteProgram(program);
+  target.destroy();
+  context.destroy();
+
+  return 0;
+}
@@ -0,0 +1,262 @@
+// Stress scene comparing the per-object `render_mesh` path against the mesh pool +
+// glMultiDrawElementsIndirect path.  Reports frame time (CPU submission plus glFinish) and the
+// draw calls, state changes and buffer uploads each path makes per frame, as counted by the
+// profiler, plus the number of indirect commands the pool path issued.  The profiler does not count
+// glUniform* calls, so the per-object path's two uniform updates per instance are listed in their
+// own column.
+//
+// Usage: indirect-benchmark [instances] [frames]
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "gl_error.h"
+#include "indirect_renderer.h"
+#include "mesh.h"
+#include "mesh_pool.h"
+#include "profiler.h"
+#include "shader_cache.h"
+
+#if !defined(CORE_GRAPHICS_RESOURCES_DIR)
+#define CORE_GRAPHICS_RESOURCES_DIR "resources"
+#endif
+
+#if !defined(CORE_GRAPHICS_PROFILING)
+#error "indirect-benchmark counts GL calls with the profiler; define CORE_GRAPHICS_PROFILING."
+#endif
+
+namespace {
+
+struct Geometry {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+};
+
+Geometry make_quad() {
+  return {{{{-0.5f, -0.5f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 0.0f}},
+           {{0.5f, -0.5f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {1.0f, 0.0f}},
+           {{0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+           {{-0.5f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.0f, 1.0f}}},
+          {0, 1, 2, 2, 3, 0}};
+}
+
+Geometry make_cube() {
+  Geometry cube;
+  for (int i = 0; i < 8; ++i) {
+    glm::vec3 p{i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f};
+    cube.vertices.push_back({p, glm::vec4{p + 0.5f, 1.0f}, {0.0f, 0.0f}});
+  }
+  cube.indices = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                  2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+  return cube;
+}
+
+Geometry make_pyramid() {
+  return {{{{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+           {{0.5f, -0.5f, -0.5f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+           {{0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+           {{-0.5f, -0.5f, 0.5f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+           {{0.0f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.5f, 0.5f}}},
+          {0, 1, 2, 2, 3, 0, 0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4}};
+}
+
+struct SceneInstance {
+  size_t mesh;
+  glm::mat4 transform;
+  uint32_t material;
+};
+
+void set_camera(const ShaderProgram& program, const glm::mat4& projection, const glm::mat4& view) {
+  glUseProgram(program.id);
+  glUniformMatrix4fv(program.reflection.uniform_location("u_projection_matrix"), 1, GL_FALSE,
+                     glm::value_ptr(projection));
+  glUniformMatrix4fv(program.reflection.uniform_location("u_view_matrix"), 1, GL_FALSE,
+                     glm::value_ptr(view));
+}
+
+struct PathStats {
+  double ms_per_frame = 0.0;
+  // Counters of the last timed frame.
+  uint64_t draw_calls = 0;
+  uint64_t state_changes = 0;
+  uint64_t buffer_uploads = 0;
+};
+
+template <typename Frame>
+PathStats time_frames(GLFWwindow* window, size_t frames, Frame frame) {
+  // Warm up so buffer allocations and shader compilation in the driver are not measured.  Closing
+  // a profiler frame also drops whatever the setup code counted.
+  PROFILE_BEGIN_FRAME();
+  frame();
+  glFinish();
+  PROFILE_END_FRAME();
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < frames; ++i) {
+    PROFILE_BEGIN_FRAME();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    frame();
+    glfwSwapBuffers(window);
+    glFinish();
+    PROFILE_END_FRAME();
+  }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+  const ProfileFrameStats& last = Profiler::instance().last_frame();
+  PathStats stats;
+  stats.ms_per_frame = elapsed.count() / double(frames);
+  stats.draw_calls = last.counters[size_t(ProfileCounter::kDrawCalls)];
+  stats.state_changes = last.counters[size_t(ProfileCounter::kStateChanges)];
+  stats.buffer_uploads = last.counters[size_t(ProfileCounter::kBufferUploads)];
+  return stats;
+}
+
+void print_path(const char* name, const PathStats& stats, uint64_t uniform_updates) {
+  std::cout << std::left << std::setw(12) << name << std::right << std::setw(9)
+            << stats.ms_per_frame << std::setw(12) << stats.draw_calls << std::setw(15)
+            << stats.state_changes << std::setw(16) << stats.buffer_uploads << std::setw(17)
+            << uniform_updates << '\n';
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t instance_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+  size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 60;
+
+  if (glfwInit() != GLFW_TRUE) {
+    return 1;
+  }
+
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow* window = glfwCreateWindow(1280, 720, "indirect-benchmark", nullptr, nullptr);
+  if (!window) {
+    return 1;
+  }
+  glfwMakeContextCurrent(window);
+  glfwSwapInterval(0);
+
+  if (!init_glew(false)) {
+    std::cerr << "Could not initialize GLEW.\n";
+    return 1;
+  }
+
+  glEnable(GL_DEPTH_TEST);
+  glViewport(0, 0, 1280, 720);
+
+  ShaderCache shader_cache{""};
+  ShaderProgram* object_program =
+      shader_cache.load(CORE_GRAPHICS_RESOURCES_DIR "/shaders/object.vert",
+                        CORE_GRAPHICS_RESOURCES_DIR "/shaders/color.frag");
+  ShaderProgram* indirect_program =
+      shader_cache.load(CORE_GRAPHICS_RESOURCES_DIR "/shaders/indirect.vert",
+                        CORE_GRAPHICS_RESOURCES_DIR "/shaders/color.frag");
+  if (!object_program || !indirect_program) {
+    return 1;
+  }
+
+  // 60 degree vertical field of view.  glm::perspective takes degrees or radians depending on the
+  // glm version, so the frustum is built from its extents instead.
+  constexpr float kNear = 0.1f;
+  const float top = kNear * std::tan(glm::radians(30.0f));
+  const float right = top * 1280.0f / 720.0f;
+  glm::mat4 projection = glm::frustum(-right, right, -top, top, kNear, 500.0f);
+  glm::mat4 view = glm::lookAt(glm::vec3{0.0f, 0.0f, -150.0f}, {0.0f, 0.0f, 0.0f},
+                               {0.0f, 1.0f, 0.0f});
+  set_camera(*object_program, projection, view);
+  set_camera(*indirect_program, projection, view);
+
+  const Geometry geometry[] = {make_quad(), make_cube(), make_pyramid()};
+  const glm::vec4 materials[] = {{1.0f, 0.3f, 0.3f, 1.0f},
+                                 {0.3f, 1.0f, 0.3f, 1.0f},
+                                 {0.3f, 0.3f, 1.0f, 1.0f},
+                                 {1.0f, 1.0f, 1.0f, 1.0f}};
+
+  // Per-object path: one Mesh (vertex array + buffers) per geometry.
+  std::vector<Mesh> meshes;
+  for (const auto& g : geometry) {
+    meshes.push_back(
+        create_mesh(g.vertices.data(), g.vertices.size(), g.indices.data(), g.indices.size()));
+  }
+
+  // Indirect path: everything in one pool.
+  MeshPool pool;
+  pool.init(1024, 4096);
+  std::vector<MeshHandle> handles(std::size(geometry));
+  for (size_t i = 0; i < std::size(geometry); ++i) {
+    pool.add(geometry[i].vertices.data(), geometry[i].vertices.size(), geometry[i].indices.data(),
+             geometry[i].indices.size(), &handles[i]);
+  }
+
+  IndirectRenderer indirect;
+  indirect.init(pool, instance_count, std::size(materials));
+  indirect.set_materials(materials, std::size(materials));
+
+  std::mt19937 rng{1234};
+  std::uniform_real_distribution<float> position{-100.0f, 100.0f};
+  std::uniform_int_distribution<size_t> mesh_index{0, std::size(geometry) - 1};
+  std::uniform_int_distribution<uint32_t> material{0, uint32_t(std::size(materials) - 1)};
+
+  std::vector<SceneInstance> scene(instance_count);
+  for (auto& instance : scene) {
+    instance.mesh = mesh_index(rng);
+    instance.transform = glm::translate(glm::mat4{1.0f},
+                                        glm::vec3{position(rng), position(rng), position(rng)});
+    instance.material = material(rng);
+  }
+
+  GLint model_location = object_program->reflection.uniform_location("u_model_matrix");
+  GLint color_location = object_program->reflection.uniform_location("u_color");
+
+  PathStats per_object = time_frames(window, frames, [&]() {
+    glUseProgram(object_program->id);
+    for (const auto& instance : scene) {
+      glUniformMatrix4fv(model_location, 1, GL_FALSE, glm::value_ptr(instance.transform));
+      glUniform4fv(color_location, 1, glm::value_ptr(materials[instance.material]));
+      render_mesh(object_program->id, GL_TRIANGLES, meshes[instance.mesh], nullptr);
+    }
+  });
+
+  PathStats indirect_path = time_frames(window, frames, [&]() {
+    indirect.clear();
+    for (const auto& instance : scene) {
+      indirect.add_instance(handles[instance.mesh], instance.transform, instance.material);
+    }
+    indirect.draw(indirect_program->id);
+  });
+
+  std::cout << "instances: " << instance_count << ", frames: " << frames
+            << ", indirect commands/frame: " << indirect.last_stats().commands << '\n';
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "path         ms/frame  draw calls  state changes  buffer uploads"
+               "  uniform updates\n";
+  print_path("per-object", per_object, 2 * instance_count);
+  print_path("indirect", indirect_path, 0);
+
+  indirect.destroy();
+  pool.destroy();
+  meshes.clear();
+  shader_cache.destroy();
+  Profiler::instance().destroy();
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  return 0;
+}
@@ -0,0 +1,270 @@
+// Frame throughput of the job system and frame pipeline on 1, 2, 4, 8 and 16 threads.
+//
+// The synthetic scene is many meshes that move and spin every frame.  Each frame, jobs simulate a
+// chunk of objects, update their transforms, cull them and record the visible ones into a per-chunk
+// draw list, while the main thread submits the previous frame's draw lists with the indirect
+// renderer.  Rendering happens on a headless EGL context; without one, the main thread only merges
+// the draw lists so the CPU side can still be measured.
+//
+// Usage: job-scaling-benchmark [objects] [frames]
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "draw_list.h"
+#include "frame_pipeline.h"
+#include "gl_error.h"
+#include "headless_context.h"
+#include "indirect_renderer.h"
+#include "job_system.h"
+#include "mesh_pool.h"
+#include "render_target.h"
+#include "shader_cache.h"
+#include "transform_stage.h"
+
+#if !defined(CORE_GRAPHICS_RESOURCES_DIR)
+#define CORE_GRAPHICS_RESOURCES_DIR "resources"
+#endif
+
+namespace {
+
+constexpr size_t kChunkSize = 4096;
+constexpr float kBounds = 100.0f;
+constexpr float kTimeStep = 1.0f / 60.0f;
+
+struct Scene {
+  TransformStage stage;
+  std::vector<glm::vec3> velocities;
+  std::vector<glm::vec3> axes;
+  std::vector<uint32_t> meshes;
+  std::vector<uint32_t> materials;
+};
+
+Scene make_scene(size_t object_count, size_t mesh_count) {
+  std::mt19937 rng{1234};
+  std::uniform_real_distribution<float> position{-kBounds, kBounds};
+  std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+  std::uniform_int_distribution<uint32_t> mesh{0, uint32_t(mesh_count - 1)};
+  std::uniform_int_distribution<uint32_t> material{0, 3};
+
+  Scene scene;
+  scene.stage.reserve(object_count);
+  for (size_t i = 0; i < object_count; ++i) {
+    glm::vec3 start{position(rng), position(rng), position(rng)};
+    scene.stage.add(start, glm::quat{1.0f, 0.0f, 0.0f, 0.0f}, glm::vec3{1.0f}, glm::vec3{0.5f});
+    scene.velocities.push_back(glm::vec3{unit(rng), unit(rng), unit(rng)} * 10.0f);
+    scene.axes.push_back(glm::normalize(glm::vec3{unit(rng), unit(rng), unit(rng)} + 0.01f));
+    scene.meshes.push_back(mesh(rng));
+    scene.materials.push_back(material(rng));
+  }
+
+  return scene;
+}
+
+// Moves, updates, culls and records objects [first, last) for `frame`.
+void prepare_chunk(Scene* scene, const std::vector<MeshHandle>& handles, const Frustum& frustum,
+                   uint64_t frame, size_t first, size_t last, std::vector<uint32_t>* visible,
+                   DrawList* list) {
+  const float time = float(frame) * kTimeStep;
+
+  for (size_t i = first; i < last; ++i) {
+    const glm::mat4& world = scene->stage.world_matrices()[i];
+    glm::vec3 position = glm::vec3{world[3]} + scene->velocities[i] * kTimeStep;
+    for (int axis = 0; axis < 3; ++axis) {
+      if (std::abs(position[axis]) > kBounds) {
+        scene->velocities[i][axis] = -scene->velocities[i][axis];
+      }
+    }
+    scene->stage.set_position(uint32_t(i), position);
+    scene->stage.set_rotation(uint32_t(i),
+                              glm::angleAxis(time * glm::radians(90.0f), scene->axes[i]));
+  }
+
+  SimdPath path = best_simd_path();
+  scene->stage.update(path, first, last);
+  scene->stage.cull_boxes(frustum, path, first, last, visible);
+
+  list->clear();
+  for (uint32_t i : *visible) {
+    list->add(handles[scene->meshes[i]], scene->stage.world_matrices()[i], scene->materials[i]);
+  }
+}
+
+struct Geometry {
+  std::vector<Vertex> vertices;
+  std::vector<uint32_t> indices;
+};
+
+Geometry make_cube() {
+  Geometry cube;
+  for (int i = 0; i < 8; ++i) {
+    glm::vec3 p{i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f};
+    cube.vertices.push_back({p, glm::vec4{p + 0.5f, 1.0f}, {0.0f, 0.0f}});
+  }
+  cube.indices = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+                  2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+  return cube;
+}
+
+Geometry make_pyramid() {
+  return {{{{-0.5f, -0.5f, -0.5f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+           {{0.5f, -0.5f, -0.5f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+           {{0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
+           {{-0.5f, -0.5f, 0.5f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
+           {{0.0f, 0.5f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, {0.5f, 0.5f}}},
+          {0, 1, 2, 2, 3, 0, 0, 1, 4, 1, 2, 4, 2, 3, 4, 3, 0, 4}};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t object_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+  size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+
+  HeadlessContext context;
+  bool gl = context.init(4, 3) && init_glew(true);
+  if (!gl) {
+    std::cout << "No OpenGL context, measuring draw list recording and merging only.\n";
+  }
+
+  RenderTarget target;
+  MeshPool pool;
+  IndirectRenderer indirect;
+  ShaderCache shader_cache{""};
+  ShaderProgram* program = nullptr;
+  std::vector<MeshHandle> handles(2);
+
+  // 60 degree vertical field of view.  glm::perspective takes degrees or radians depending on the
+  // glm version, so the frustum is built from its extents instead.
+  constexpr float kNear = 0.1f;
+  const float top = kNear * std::tan(glm::radians(30.0f));
+  const float right = top * 16.0f / 9.0f;
+  const glm::mat4 projection = glm::frustum(-right, right, -top, top, kNear, 500.0f);
+  const glm::mat4 view =
+      glm::lookAt(glm::vec3{0.0f, 0.0f, -150.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f});
+  const Frustum frustum = extract_frustum(projection * view);
+
+  if (gl) {
+    if (!target.init(640, 360)) {
+      return 1;
+    }
+    target.bind();
+    glEnable(GL_DEPTH_TEST);
+
+    program = shader_cache.load(CORE_GRAPHICS_RESOURCES_DIR "/shaders/indirect.vert",
+                                CORE_GRAPHICS_RESOURCES_DIR "/shaders/color.frag");
+    if (!program) {
+      return 1;
+    }
+    glUseProgram(program->id);
+    glUniformMatrix4fv(program->reflection.uniform_location("u_projection_matrix"), 1, GL_FALSE,
+                       glm::value_ptr(projection));
+    glUniformMatrix4fv(program->reflection.uniform_location("u_view_matrix"), 1, GL_FALSE,
+                       glm::value_ptr(view));
+
+    const Geometry geometry[] = {make_cube(), make_pyramid()};
+    pool.init(1024, 4096);
+    for (size_t i = 0; i < std::size(geometry); ++i) {
+      pool.add(geometry[i].vertices.data(), geometry[i].vertices.size(),
+               geometry[i].indices.data(), geometry[i].indices.size(), &handles[i]);
+    }
+
+    const glm::vec4 materials[] = {{1.0f, 0.3f, 0.3f, 1.0f},
+                                   {0.3f, 1.0f, 0.3f, 1.0f},
+                                   {0.3f, 0.3f, 1.0f, 1.0f},
+                                   {1.0f, 1.0f, 1.0f, 1.0f}};
+    indirect.init(pool, object_count, std::size(materials));
+    indirect.set_materials(materials, std::size(materials));
+  }
+
+  const size_t chunk_count = (object_count + kChunkSize - 1) / kChunkSize;
+
+  std::cout << "objects: " << object_count << ", frames: " << frames
+            << ", hardware threads: " << std::thread::hardware_concurrency() << '\n';
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "threads   frames/s   ms/frame   speedup   visible/frame\n";
+
+  double single_thread_fps = 0.0;
+  for (size_t thread_count : {1, 2, 4, 8, 16}) {
+    Scene scene = make_scene(object_count, handles.size());
+    scene.stage.update(SimdPath::kScalar);
+
+    // Per slot and chunk: visible indices and the recorded draw list.
+    std::vector<std::vector<uint32_t>> visible[FramePipeline::kSlotCount];
+    std::vector<DrawList> lists[FramePipeline::kSlotCount];
+    for (size_t slot = 0; slot < FramePipeline::kSlotCount; ++slot) {
+      visible[slot].resize(chunk_count);
+      lists[slot].resize(chunk_count);
+    }
+
+    JobSystem jobs{thread_count};
+    size_t visible_total = 0;
+
+    auto prepare = [&](uint64_t frame, size_t slot, JobCounter* counter) {
+      jobs.parallel_for(
+          object_count, kChunkSize,
+          [&, frame, slot](size_t first, size_t last) {
+            size_t chunk = first / kChunkSize;
+            prepare_chunk(&scene, handles, frustum, frame, first, last, &visible[slot][chunk],
+                          &lists[slot][chunk]);
+          },
+          counter);
+    };
+
+    auto render = [&](uint64_t, size_t slot) {
+      indirect.clear();
+      for (const auto& list : lists[slot]) {
+        visible_total += list.items().size();
+        if (gl) {
+          indirect.add_draw_list(list);
+        }
+      }
+      if (gl) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        indirect.draw(program->id);
+      }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    {
+      FramePipeline pipeline{&jobs, prepare, render};
+      for (size_t frame = 0; frame < frames; ++frame) {
+        pipeline.run_frame();
+      }
+    }
+    if (gl) {
+      glFinish();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double fps = double(frames) / elapsed.count();
+    if (thread_count == 1) {
+      single_thread_fps = fps;
+    }
+    std::cout << std::setw(7) << thread_count << std::setw(11) << fps << std::setw(11)
+              << 1000.0 / fps << std::setw(10) << fps / single_thread_fps << std::setw(16)
+              << visible_total / frames << '\n';
+  }
+
+  if (gl) {
+    indirect.destroy();
+    pool.destroy();
+    shader_cache.destroy();
+    target.destroy();
+  }
+  context.destroy();
+
+  return 0;
+}
@@ -0,0 +1,75 @@
+// Measures the CPU cost of the batch renderer: submitting, sorting and expanding quads into a
+// vertex buffer.  Does not need an OpenGL context, so it runs headless (e.g. next to Mesa llvmpipe).
+//
+// Usage: quad-batch-benchmark [quads_per_frame] [textures] [programs] [frames]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "quad_batch.h"
+
+int main(int argc, char* argv[]) {
+  size_t quads_per_frame = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+  uint32_t texture_count = argc > 2 ? uint32_t(std::strtoul(argv[2], nullptr, 10)) : 16;
+  uint32_t program_count = argc > 3 ? uint32_t(std::strtoul(argv[3], nullptr, 10)) : 2;
+  size_t frames = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 200;
+
+  // Matches the region size the batch renderer would use for one frame.
+  constexpr size_t kMaxQuadsPerFlush = 16384;
+
+  std::mt19937 rng{1234};
+  std::uniform_real_distribution<float> position{-1.0f, 1.0f};
+  std::uniform_int_distribution<uint32_t> texture{1, texture_count};
+  std::uniform_int_distribution<uint32_t> program{1, program_count};
+
+  struct Submission {
+    uint32_t program;
+    uint32_t texture;
+    Quad quad;
+  };
+
+  std::vector<Submission> submissions(quads_per_frame);
+  for (auto& s : submissions) {
+    s.program = program(rng);
+    s.texture = texture(rng);
+    s.quad.position = {position(rng), position(rng), 0.0f};
+    s.quad.size = {0.01f, 0.01f};
+  }
+
+  QuadBatch batch;
+  std::vector<Vertex> vertices(kMaxQuadsPerFlush * QuadBatch::kVerticesPerQuad);
+  std::vector<BatchDrawCommand> commands;
+  size_t total_draw_calls = 0;
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t frame = 0; frame < frames; ++frame) {
+    batch.clear();
+    for (const auto& s : submissions) {
+      batch.submit(s.program, s.texture, s.quad);
+    }
+    batch.sort();
+
+    for (size_t first = 0; first < batch.quad_count();) {
+      commands.clear();
+      first += batch.build(first, kMaxQuadsPerFlush, vertices.data(), &commands);
+      total_draw_calls += commands.size();
+    }
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  double seconds = elapsed.count();
+  std::cout << "quads/frame:      " << quads_per_frame << '\n';
+  std::cout << "textures:         " << texture_count << '\n';
+  std::cout << "programs:         " << program_count << '\n';
+  std::cout << "frames:           " << frames << '\n';
+  std::cout << "ms/frame:         " << seconds * 1000.0 / double(frames) << '\n';
+  std::cout << "quads/sec:        " << double(quads_per_frame * frames) / seconds << '\n';
+  std::cout << "draw calls/frame: " << double(total_draw_calls) / double(frames) << '\n';
+
+  return 0;
+}
@@ -0,0 +1,152 @@
+// Quality and speed of the CPU block compressors.  For every format and encoder path, reports
+// encode throughput in megapixels per second, PSNR of the decoded result against the source, and
+// the memory of the compressed mip chain compared with the RGBA8 one uploaded today.  Also checks
+// that the scalar and SSE paths produce identical blocks.  No GL context is needed.
+//
+// PSNR is reported separately for color and alpha.  BC1 is meant for opaque textures, so it
+// compresses an opaque copy of the image.
+//
+// Without an image argument, a synthetic 1024x1024 image with gradients, noise, hard edges and an
+// alpha ramp is used, since the bundled texture is too small to time.
+//
+// Usage: texture-compression-benchmark [image] [min_seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "compressed_image.h"
+#include "image.h"
+#include "texture_compression.h"
+
+namespace {
+
+Image make_test_image(int size) {
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<int> noise{-12, 12};
+
+  Image image;
+  image.width = size;
+  image.height = size;
+  image.pixels.resize(size_t(size) * size_t(size) * 4);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      uint8_t* texel = image.pixels.data() + (size_t(y) * size_t(size) + size_t(x)) * 4;
+      float u = float(x) / float(size);
+      float v = float(y) / float(size);
+      int r = int(255.0f * (0.5f + 0.5f * std::sin(u * 12.0f + v * 3.0f)));
+      int g = int(255.0f * v);
+      int b = ((x / 64) + (y / 64)) % 2 ? 220 : 40;
+      texel[0] = uint8_t(std::clamp(r + noise(rng), 0, 255));
+      texel[1] = uint8_t(std::clamp(g + noise(rng), 0, 255));
+      texel[2] = uint8_t(std::clamp(b + noise(rng), 0, 255));
+      texel[3] = uint8_t(255.0f * u);
+    }
+  }
+
+  return image;
+}
+
+// PSNR in dB over channels [first, last).
+double psnr(const Image& a, const Image& b, int first, int last) {
+  double squared_error = 0.0;
+  for (size_t i = 0; i < a.pixels.size(); i += 4) {
+    for (int c = first; c < last; ++c) {
+      double error = double(a.pixels[i + c]) - double(b.pixels[i + c]);
+      squared_error += error * error;
+    }
+  }
+
+  double mean_squared_error = squared_error / double(a.pixels.size() / 4 * size_t(last - first));
+  return mean_squared_error > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mean_squared_error)
+                                  : std::numeric_limits<double>::infinity();
+}
+
+size_t rgba_mip_chain_size(int width, int height) {
+  size_t size = 0;
+  for (;;) {
+    size += size_t(width) * size_t(height) * 4;
+    if (width == 1 && height == 1) {
+      return size;
+    }
+    width = std::max(width / 2, 1);
+    height = std::max(height / 2, 1);
+  }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Image image;
+  if (argc > 1) {
+    if (!load_image(argv[1], &image)) {
+      return 1;
+    }
+  } else {
+    image = make_test_image(1024);
+  }
+  double min_seconds = argc > 2 ? std::atof(argv[2]) : 0.5;
+
+  const double megapixels = double(image.width) * double(image.height) / 1e6;
+  const size_t rgba_size = rgba_mip_chain_size(image.width, image.height);
+
+  std::cout << "image: " << image.width << "x" << image.height << ", RGBA8 with mips: "
+            << rgba_size / 1024 << " KiB\n";
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "format  path       MPix/s   RGB dB   alpha dB   KiB with mips   saved\n";
+
+  Image opaque = image;
+  for (size_t i = 3; i < opaque.pixels.size(); i += 4) {
+    opaque.pixels[i] = 255;
+  }
+
+  bool all_identical = true;
+  for (BlockFormat format : {BlockFormat::kBC1, BlockFormat::kBC3, BlockFormat::kBC7}) {
+    const Image& source = format == BlockFormat::kBC1 ? opaque : image;
+    std::vector<uint8_t> reference;
+    for (EncoderPath path : {EncoderPath::kScalar, EncoderPath::kSse}) {
+      if (path == EncoderPath::kSse && best_encoder_path() != EncoderPath::kSse) {
+        continue;
+      }
+
+      std::vector<uint8_t> blocks;
+      size_t runs = 0;
+      auto start = std::chrono::steady_clock::now();
+      std::chrono::duration<double> elapsed{};
+      do {
+        blocks.clear();
+        encode_image(source, format, path, &blocks);
+        ++runs;
+        elapsed = std::chrono::steady_clock::now() - start;
+      } while (elapsed.count() < min_seconds);
+
+      if (reference.empty()) {
+        reference = blocks;
+      } else if (blocks != reference) {
+        std::cout << block_format_name(format) << ": scalar and SSE blocks differ.\n";
+        all_identical = false;
+      }
+
+      Image decoded;
+      decode_blocks(blocks.data(), format, source.width, source.height, &decoded);
+
+      CompressedImage compressed;
+      compress_image(source, format, path, true, &compressed);
+
+      std::cout << std::left << std::setw(8) << block_format_name(format) << std::setw(8)
+                << encoder_path_name(path) << std::right << std::setw(9)
+                << megapixels * double(runs) / elapsed.count() << std::setw(9)
+                << psnr(source, decoded, 0, 3) << std::setw(11) << psnr(source, decoded, 3, 4)
+                << std::setw(16) << compressed.data.size() / 1024 << std::setw(7)
+                << 100.0 * (1.0 - double(compressed.data.size()) / double(rgba_size)) << "%\n";
+    }
+  }
+
+  return all_identical ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// Measures ns/object for the transform update and frustum culling kernels of `TransformStage` on
+// every SIMD path the CPU supports, and checks the SIMD results against the scalar path.
+//
+// Usage: transform-benchmark [runs]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "transform_stage.h"
+
+namespace {
+
+template <typename Work>
+double ns_per_object(size_t objects, size_t runs, Work work) {
+  work();
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t run = 0; run < runs; ++run) {
+    work();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+  return elapsed.count() / double(runs * objects);
+}
+
+float max_difference(const glm::mat4* a, const glm::mat4* b, size_t count) {
+  float difference = 0.0f;
+  for (size_t i = 0; i < count; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      for (int r = 0; r < 4; ++r) {
+        difference = std::max(difference, std::abs(a[i][c][r] - b[i][c][r]));
+      }
+    }
+  }
+  return difference;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  size_t runs = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+
+  SimdPath best = best_simd_path();
+  std::vector<SimdPath> paths = {SimdPath::kScalar};
+  if (best != SimdPath::kScalar) {
+    paths.push_back(SimdPath::kSse);
+  }
+  if (best == SimdPath::kAvx) {
+    paths.push_back(SimdPath::kAvx);
+  }
+
+  // Camera in the middle of the scene with a 60 degree vertical field of view, so roughly a tenth
+  // of the objects are visible.  glm::perspective takes degrees or radians depending on the glm
+  // version, so the frustum is built from its extents instead.
+  constexpr float kNear = 0.1f;
+  const float top = kNear * std::tan(glm::radians(30.0f));
+  const float right = top * 16.0f / 9.0f;
+  glm::mat4 projection = glm::frustum(-right, right, -top, top, kNear, 500.0f);
+  glm::mat4 view =
+      glm::lookAt(glm::vec3{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f, 0.0f});
+  Frustum frustum = extract_frustum(projection * view);
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "objects   path     update  spheres    boxes  visible  max error\n";
+
+  for (size_t object_count : {10000, 100000, 1000000}) {
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> position{-500.0f, 500.0f};
+    std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+    std::uniform_real_distribution<float> size{0.5f, 4.0f};
+
+    TransformStage stage;
+    stage.reserve(object_count);
+    for (size_t i = 0; i < object_count; ++i) {
+      glm::quat rotation =
+          glm::normalize(glm::quat{unit(rng), unit(rng), unit(rng), unit(rng) + 0.01f});
+      stage.add({position(rng), position(rng), position(rng)}, rotation,
+                glm::vec3{size(rng)}, {size(rng), size(rng), size(rng)});
+    }
+
+    // Reference results from the scalar path.
+    stage.update(SimdPath::kScalar);
+    std::vector<glm::mat4> reference(stage.world_matrices(),
+                                     stage.world_matrices() + object_count);
+    std::vector<uint32_t> reference_visible;
+    stage.cull_boxes(frustum, SimdPath::kScalar, &reference_visible);
+
+    std::vector<uint32_t> visible;
+    for (SimdPath path : paths) {
+      double update_ns = ns_per_object(object_count, runs, [&]() { stage.update(path); });
+      double spheres_ns = ns_per_object(object_count, runs,
+                                        [&]() { stage.cull_spheres(frustum, path, &visible); });
+      double boxes_ns = ns_per_object(object_count, runs,
+                                      [&]() { stage.cull_boxes(frustum, path, &visible); });
+
+      float error = max_difference(stage.world_matrices(), reference.data(), object_count);
+
+      std::cout << std::setw(7) << object_count << "   " << std::setw(6) << std::left
+                << simd_path_name(path) << std::right << std::setw(9) << update_ns
+                << std::setw(9) << spheres_ns << std::setw(9) << boxes_ns << std::setw(9)
+                << visible.size() << std::setw(11) << std::setprecision(6) << error
+                << std::setprecision(2) << '\n';
+
+      // Objects right on a plane may flip due to rounding, so only report differences.
+      if (visible != reference_visible) {
+        std::cout << "  " << simd_path_name(path) << " box culling differs from scalar ("
+                  << visible.size() << " vs " << reference_visible.size() << " visible)\n";
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,350 @@
+#include "compressed_image.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "mapped_file.h"
+
+namespace {
+
+constexpr uint32_t kDdsMagic = 0x20534444;  // "DDS "
+constexpr uint32_t kFourCCDxt1 = 0x31545844;  // "DXT1"
+constexpr uint32_t kFourCCDxt5 = 0x35545844;  // "DXT5"
+constexpr uint32_t kFourCCDx10 = 0x30315844;  // "DX10"
+
+constexpr uint32_t kDdsFlagsTexture = 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000;
+constexpr uint32_t kDdsFlagMipMapCount = 0x20000;
+constexpr uint32_t kDdsPixelFormatFourCC = 0x4;
+constexpr uint32_t kDdsCapsTexture = 0x1000;
+constexpr uint32_t kDdsCapsMipMap = 0x8 | 0x400000;
+constexpr uint32_t kDdsCaps2CubeMap = 0x200;
+constexpr uint32_t kDdsCaps2Volume = 0x200000;
+constexpr uint32_t kDx10ResourceTexture2D = 3;
+constexpr uint32_t kDx10MiscTextureCube = 0x4;
+
+struct DdsPixelFormat {
+  uint32_t size;
+  uint32_t flags;
+  uint32_t four_cc;
+  uint32_t rgb_bit_count;
+  uint32_t masks[4];
+};
+
+struct DdsHeader {
+  uint32_t size;
+  uint32_t flags;
+  uint32_t height;
+  uint32_t width;
+  uint32_t pitch_or_linear_size;
+  uint32_t depth;
+  uint32_t mip_map_count;
+  uint32_t reserved1[11];
+  DdsPixelFormat pixel_format;
+  uint32_t caps;
+  uint32_t caps2;
+  uint32_t caps3;
+  uint32_t caps4;
+  uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+  uint32_t dxgi_format;
+  uint32_t resource_dimension;
+  uint32_t misc_flag;
+  uint32_t array_size;
+  uint32_t misc_flags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DdsHeader layout changed");
+static_assert(sizeof(DdsHeaderDx10) == 20, "DdsHeaderDx10 layout changed");
+
+constexpr uint8_t kKtx2Identifier[12] = {0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a,
+                                         '\n'};
+
+struct Ktx2Header {
+  uint8_t identifier[12];
+  uint32_t vk_format;
+  uint32_t type_size;
+  uint32_t pixel_width;
+  uint32_t pixel_height;
+  uint32_t pixel_depth;
+  uint32_t layer_count;
+  uint32_t face_count;
+  uint32_t level_count;
+  uint32_t supercompression_scheme;
+  uint32_t dfd_byte_offset;
+  uint32_t dfd_byte_length;
+  uint32_t kvd_byte_offset;
+  uint32_t kvd_byte_length;
+  uint64_t sgd_byte_offset;
+  uint64_t sgd_byte_length;
+};
+
+struct Ktx2Level {
+  uint64_t byte_offset;
+  uint64_t byte_length;
+  uint64_t uncompressed_byte_length;
+};
+
+static_assert(sizeof(Ktx2Header) == 80, "Ktx2Header layout changed");
+static_assert(sizeof(Ktx2Level) == 24, "Ktx2Level layout changed");
+
+bool format_from_dxgi(uint32_t dxgi_format, BlockFormat* format) {
+  switch (dxgi_format) {
+    case 71:  // DXGI_FORMAT_BC1_UNORM
+    case 72:  // DXGI_FORMAT_BC1_UNORM_SRGB
+      *format = BlockFormat::kBC1;
+      return true;
+    case 77:  // DXGI_FORMAT_BC3_UNORM
+    case 78:  // DXGI_FORMAT_BC3_UNORM_SRGB
+      *format = BlockFormat::kBC3;
+      return true;
+    case 98:  // DXGI_FORMAT_BC7_UNORM
+    case 99:  // DXGI_FORMAT_BC7_UNORM_SRGB
+      *format = BlockFormat::kBC7;
+      return true;
+  }
+  return false;
+}
+
+bool format_from_vulkan(uint32_t vk_format, BlockFormat* format) {
+  switch (vk_format) {
+    case 131:  // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    case 132:  // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+    case 133:  // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+    case 134:  // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+      *format = BlockFormat::kBC1;
+      return true;
+    case 137:  // VK_FORMAT_BC3_UNORM_BLOCK
+    case 138:  // VK_FORMAT_BC3_SRGB_BLOCK
+      *format = BlockFormat::kBC3;
+      return true;
+    case 145:  // VK_FORMAT_BC7_UNORM_BLOCK
+    case 146:  // VK_FORMAT_BC7_SRGB_BLOCK
+      *format = BlockFormat::kBC7;
+      return true;
+  }
+  return false;
+}
+
+// Rejects sizes that do not fit in an int and mip chains longer than a full one.
+bool valid_dimensions(uint32_t width, uint32_t height, uint32_t level_count) {
+  if (width == 0 || height == 0 || width > INT_MAX || height > INT_MAX) {
+    return false;
+  }
+
+  uint32_t max_level_count = 1;
+  while ((std::max(width, height) >> max_level_count) != 0) {
+    ++max_level_count;
+  }
+  return level_count <= max_level_count;
+}
+
+void add_level(CompressedImage* image, const uint8_t* data, size_t size) {
+  size_t level = image->levels.size();
+  int width = std::max(image->width >> level, 1);
+  int height = std::max(image->height >> level, 1);
+  image->levels.push_back({width, height, image->data.size(), size});
+  image->data.insert(image->data.end(), data, data + size);
+}
+
+}  // namespace
+
+void compress_image(const Image& image, BlockFormat format, EncoderPath path, bool mips,
+                    CompressedImage* compressed) {
+  compressed->format = format;
+  compressed->width = image.width;
+  compressed->height = image.height;
+  compressed->levels.clear();
+  compressed->data.clear();
+
+  const Image* current = &image;
+  Image smaller;
+  for (;;) {
+    size_t offset = compressed->data.size();
+    encode_image(*current, format, path, &compressed->data);
+    compressed->levels.push_back(
+        {current->width, current->height, offset, compressed->data.size() - offset});
+
+    if (!mips || (current->width == 1 && current->height == 1)) {
+      break;
+    }
+    smaller = half_size(*current);
+    current = &smaller;
+  }
+}
+
+bool parse_dds(const uint8_t* data, size_t size, CompressedImage* image) {
+  uint32_t magic = 0;
+  DdsHeader header;
+  if (size < sizeof(magic) + sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&magic, data, sizeof(magic));
+  std::memcpy(&header, data + sizeof(magic), sizeof(header));
+  size_t offset = sizeof(magic) + sizeof(header);
+  if (magic != kDdsMagic || header.size != sizeof(header) ||
+      !(header.pixel_format.flags & kDdsPixelFormatFourCC)) {
+    return false;
+  }
+  if (header.caps2 & (kDdsCaps2CubeMap | kDdsCaps2Volume)) {
+    return false;
+  }
+
+  switch (header.pixel_format.four_cc) {
+    case kFourCCDxt1:
+      image->format = BlockFormat::kBC1;
+      break;
+    case kFourCCDxt5:
+      image->format = BlockFormat::kBC3;
+      break;
+    case kFourCCDx10: {
+      DdsHeaderDx10 dx10;
+      if (size < offset + sizeof(dx10)) {
+        return false;
+      }
+      std::memcpy(&dx10, data + offset, sizeof(dx10));
+      offset += sizeof(dx10);
+      if (!format_from_dxgi(dx10.dxgi_format, &image->format) ||
+          dx10.resource_dimension != kDx10ResourceTexture2D || dx10.array_size > 1 ||
+          (dx10.misc_flag & kDx10MiscTextureCube)) {
+        return false;
+      }
+      break;
+    }
+    default:
+      return false;
+  }
+
+  uint32_t level_count = std::max(header.mip_map_count, 1u);
+  if (!valid_dimensions(header.width, header.height, level_count)) {
+    return false;
+  }
+
+  image->width = int(header.width);
+  image->height = int(header.height);
+  image->levels.clear();
+  image->data.clear();
+
+  for (uint32_t level = 0; level < level_count; ++level) {
+    size_t level_size = compressed_size(image->format, std::max(image->width >> level, 1),
+                                        std::max(image->height >> level, 1));
+    if (level_size > size - offset) {
+      return false;
+    }
+    add_level(image, data + offset, level_size);
+    offset += level_size;
+  }
+
+  return true;
+}
+
+bool parse_ktx2(const uint8_t* data, size_t size, CompressedImage* image) {
+  Ktx2Header header;
+  if (size < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.identifier, kKtx2Identifier, sizeof(kKtx2Identifier)) != 0 ||
+      !format_from_vulkan(header.vk_format, &image->format)) {
+    return false;
+  }
+  if (header.pixel_depth > 1 || header.layer_count > 1 || header.face_count != 1 ||
+      header.supercompression_scheme != 0) {
+    return false;
+  }
+
+  uint32_t level_count = std::max(header.level_count, 1u);
+  if (!valid_dimensions(header.pixel_width, header.pixel_height, level_count) ||
+      size < sizeof(header) + size_t(level_count) * sizeof(Ktx2Level)) {
+    return false;
+  }
+
+  image->width = int(header.pixel_width);
+  image->height = int(header.pixel_height);
+  image->levels.clear();
+  image->data.clear();
+
+  // The level index starts with the base level even though the data is stored smallest first.
+  for (uint32_t level = 0; level < level_count; ++level) {
+    Ktx2Level entry;
+    std::memcpy(&entry, data + sizeof(header) + level * sizeof(Ktx2Level), sizeof(entry));
+    size_t level_size = compressed_size(image->format, std::max(image->width >> level, 1),
+                                        std::max(image->height >> level, 1));
+    if (entry.byte_length != level_size || entry.byte_offset > size ||
+        entry.byte_length > size - entry.byte_offset) {
+      return false;
+    }
+    add_level(image, data + entry.byte_offset, level_size);
+  }
+
+  return true;
+}
+
+bool load_compressed_image(std::string_view path, CompressedImage* image) {
+  std::string p{path};
+
+  MappedFile file;
+  if (!file.open(p)) {
+    std::cerr << "Could not open " << p << ".\n";
+    return false;
+  }
+
+  bool ktx2 = file.size() >= sizeof(kKtx2Identifier) &&
+              std::memcmp(file.data(), kKtx2Identifier, sizeof(kKtx2Identifier)) == 0;
+  if (!(ktx2 ? parse_ktx2 : parse_dds)(file.data(), file.size(), image)) {
+    std::cerr << "Compressed image " << p << " is corrupt or has an unsupported format.\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool write_dds(std::string_view path, const CompressedImage& image) {
+  std::string p{path};
+
+  DdsHeader header{};
+  header.size = sizeof(header);
+  header.flags = kDdsFlagsTexture | (image.levels.size() > 1 ? kDdsFlagMipMapCount : 0);
+  header.height = uint32_t(image.height);
+  header.width = uint32_t(image.width);
+  header.pitch_or_linear_size = image.levels.empty() ? 0 : uint32_t(image.levels[0].size);
+  header.mip_map_count = uint32_t(image.levels.size());
+  header.pixel_format.size = sizeof(DdsPixelFormat);
+  header.pixel_format.flags = kDdsPixelFormatFourCC;
+  header.caps = kDdsCapsTexture | (image.levels.size() > 1 ? kDdsCapsMipMap : 0);
+
+  DdsHeaderDx10 dx10{};
+  switch (image.format) {
+    case BlockFormat::kBC1:
+      header.pixel_format.four_cc = kFourCCDxt1;
+      break;
+    case BlockFormat::kBC3:
+      header.pixel_format.four_cc = kFourCCDxt5;
+      break;
+    case BlockFormat::kBC7:
+      header.pixel_format.four_cc = kFourCCDx10;
+      dx10.dxgi_format = 98;  // DXGI_FORMAT_BC7_UNORM
+      dx10.resource_dimension = kDx10ResourceTexture2D;
+      dx10.array_size = 1;
+      break;
+  }
+
+  std::ofstream out{p, std::ios::binary};
+  out.write(reinterpret_cast<const char*>(&kDdsMagic), sizeof(kDdsMagic));
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (header.pixel_format.four_cc == kFourCCDx10) {
+    out.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+  }
+  out.write(reinterpret_cast<const char*>(image.data.data()), std::streamsize(image.data.size()));
+  if (!out) {
+    std::cerr << "Could not write " << p << ".\n";
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "image.h"
+#include "texture_compression.h"
+
+// A block compressed image with its mip chain, largest level first.
+struct CompressedImage {
+  struct Level {
+    int width;
+    int height;
+    size_t offset;
+    size_t size;
+  };
+
+  BlockFormat format = BlockFormat::kBC1;
+  int width = 0;
+  int height = 0;
+  std::vector<Level> levels;
+  std::vector<uint8_t> data;
+
+  const uint8_t* level_data(size_t level) const {
+    return data.data() + levels[level].offset;
+  }
+};
+
+// Encodes `image`, and with `mips` every box filtered level down to 1x1.
+void compress_image(const Image& image, BlockFormat format, EncoderPath path, bool mips,
+                    CompressedImage* compressed);
+
+// Loads a DDS (DXT1, DXT5 or DX10 with BC1/BC3/BC7) or KTX2 (BC1/BC3/BC7, no supercompression)
+// file, chosen by its signature.  Only single 2D images are supported: no arrays, cube maps or
+// volume textures.  sRGB formats load as their UNORM counterparts.
+bool load_compressed_image(std::string_view path, CompressedImage* image);
+
+bool parse_dds(const uint8_t* data, size_t size, CompressedImage* image);
+bool parse_ktx2(const uint8_t* data, size_t size, CompressedImage* image);
+
+// Writes a DDS file: DXT1 and DXT5 with the legacy header, BC7 with the DX10 extension.
+bool write_dds(std::string_view path, const CompressedImage& image);
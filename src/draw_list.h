@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "mesh_pool.h"
+
+struct DrawItem {
+  MeshHandle mesh;
+  glm::mat4 transform;
+  uint32_t material;
+};
+
+// Draws recorded without touching OpenGL, so lists can be filled on worker threads and submitted
+// on the thread that owns the context.
+class DrawList {
+public:
+  void clear() {
+    items_.clear();
+  }
+
+  void reserve(size_t count) {
+    items_.reserve(count);
+  }
+
+  void add(const MeshHandle& mesh, const glm::mat4& transform, uint32_t material) {
+    items_.push_back({mesh, transform, material});
+  }
+
+  const std::vector<DrawItem>& items() const {
+    return items_;
+  }
+
+private:
+  std::vector<DrawItem> items_;
+};
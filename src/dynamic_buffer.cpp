@@ -0,0 +1,136 @@
+#include "dynamic_buffer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "gl_error.h"
+#include "profiler.h"
+
+DynamicBufferRing::~DynamicBufferRing() {
+  destroy();
+}
+
+bool DynamicBufferRing::init(GLenum target, size_t region_size) {
+  target_ = target;
+  region_size_ = region_size;
+
+  const auto buffer_size = GLsizeiptr(kRegionCount * region_size);
+
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(target, buffer_);
+
+  if (GLEW_ARB_buffer_storage) {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(target, buffer_size, nullptr, flags);
+    GLError();
+    mapped_ = static_cast<uint8_t*>(glMapBufferRange(target, 0, buffer_size, flags));
+    GLError();
+    if (!mapped_) {
+      std::cerr << "Could not map dynamic buffer.\n";
+      return false;
+    }
+  } else {
+    glBufferData(target, buffer_size, nullptr, GL_STREAM_DRAW);
+    GLError();
+    staging_.resize(region_size);
+  }
+
+  return true;
+}
+
+void DynamicBufferRing::destroy() {
+  for (auto& fence : fences_) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  if (mapped_) {
+    glBindBuffer(target_, buffer_);
+    glUnmapBuffer(target_);
+    mapped_ = nullptr;
+  }
+
+  if (buffer_) {
+    glDeleteBuffers(1, &buffer_);
+    buffer_ = 0;
+  }
+
+  staging_.clear();
+  region_ = kRegionCount - 1;
+  used_ = 0;
+  flushed_ = 0;
+}
+
+void DynamicBufferRing::begin_region() {
+  region_ = (region_ + 1) % kRegionCount;
+  used_ = 0;
+  flushed_ = 0;
+
+  GLsync& fence = fences_[region_];
+  if (!fence) {
+    return;
+  }
+
+  // Only blocks if the GPU is still reading the region from `kRegionCount` regions ago.
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    PROFILE_ZONE("DynamicBufferRing::stall");
+    auto start = std::chrono::steady_clock::now();
+    while (result == GL_TIMEOUT_EXPIRED) {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    stall_ms_ += elapsed.count();
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void* DynamicBufferRing::allocate(size_t size, size_t alignment, GLintptr* offset) {
+  const size_t region_start = region_ * region_size_;
+
+  // Align the offset into the whole buffer, not into the region, so it is valid for GL.
+  size_t start = region_start + used_;
+  if (alignment > 1) {
+    start = (start + alignment - 1) / alignment * alignment;
+  }
+  if (start + size > region_start + region_size_) {
+    return nullptr;
+  }
+
+  used_ = start + size - region_start;
+  *offset = GLintptr(start);
+
+  if (mapped_) {
+    return mapped_ + start;
+  }
+  return staging_.data() + (start - region_start);
+}
+
+void DynamicBufferRing::flush_writes() {
+  if (used_ == flushed_) {
+    return;
+  }
+
+  PROFILE_COUNT(kBufferUploads, 1);
+  PROFILE_COUNT(kUploadBytes, used_ - flushed_);
+
+  // Coherent mappings need no flush.
+  if (!mapped_) {
+    glBindBuffer(target_, buffer_);
+    glBufferSubData(target_, GLintptr(region_ * region_size_ + flushed_),
+                    GLsizeiptr(used_ - flushed_), staging_.data() + flushed_);
+    GLError();
+  }
+
+  flushed_ = used_;
+}
+
+void DynamicBufferRing::end_region() {
+  if (mapped_) {
+    fences_[region_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+}
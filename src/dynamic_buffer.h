@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streams per-frame data (vertices, instance data, ...) to the GPU without reallocating buffers.
+//
+// One buffer is allocated with glBufferStorage and stays persistently and coherently mapped.  It is
+// split into `kRegionCount` regions that are used round robin, one per frame (or flush).  Each
+// region is fenced after the draws that read it are issued, so by the time the ring wraps around
+// to it the GPU is normally done and the CPU can write into it without waiting.
+//
+// Usage per region:
+//
+//   ring.begin_region();
+//   Vertex* vertices = ring.allocate<Vertex>(count, &offset);
+//   ... write vertices ...
+//   ring.flush_writes();
+//   ... draw from ring.buffer() at offset ...
+//   ring.end_region();
+//
+// If GL_ARB_buffer_storage is not available, allocations come from client memory and
+// `flush_writes` uploads them with glBufferSubData.
+class DynamicBufferRing {
+public:
+  static constexpr size_t kRegionCount = 3;
+
+  DynamicBufferRing() = default;
+  ~DynamicBufferRing();
+
+  DynamicBufferRing(const DynamicBufferRing&) = delete;
+  DynamicBufferRing& operator=(const DynamicBufferRing&) = delete;
+
+  // Leaves the buffer bound to `target`.
+  bool init(GLenum target, size_t region_size);
+  void destroy();
+
+  // Waits until the GPU has finished with the next region and makes it current.
+  void begin_region();
+
+  // Returns `size` bytes of the current region, with the offset into `buffer()` aligned to
+  // `alignment`, or nullptr if the region is full.
+  void* allocate(size_t size, size_t alignment, GLintptr* offset);
+
+  // Room for `count` elements.  The offset is a multiple of sizeof(T), so `offset / sizeof(T)` can
+  // be used as a base vertex.
+  template <typename T>
+  T* allocate(size_t count, GLintptr* offset) {
+    return static_cast<T*>(allocate(count * sizeof(T), sizeof(T), offset));
+  }
+
+  // Makes everything allocated in the current region visible to GL.  Call before drawing.
+  void flush_writes();
+
+  // Fences the current region.  Call after the draws that read from it.
+  void end_region();
+
+  GLuint buffer() const {
+    return buffer_;
+  }
+
+  size_t region_size() const {
+    return region_size_;
+  }
+
+  bool persistent() const {
+    return mapped_ != nullptr;
+  }
+
+  // Total time `begin_region` spent waiting for the GPU.
+  double stall_ms() const {
+    return stall_ms_;
+  }
+
+private:
+  GLenum target_ = GL_ARRAY_BUFFER;
+  GLuint buffer_ = 0;
+  size_t region_size_ = 0;
+
+  uint8_t* mapped_ = nullptr;
+  std::vector<uint8_t> staging_;
+
+  size_t region_ = kRegionCount - 1;
+  size_t used_ = 0;
+  size_t flushed_ = 0;
+  GLsync fences_[kRegionCount] = {};
+  double stall_ms_ = 0.0;
+};
@@ -0,0 +1,42 @@
+#include "frame_pipeline.h"
+
+#include <utility>
+
+#include "profiler.h"
+
+FramePipeline::FramePipeline(JobSystem* jobs, Prepare prepare, Render render)
+    : jobs_{jobs}, prepare_{std::move(prepare)}, render_{std::move(render)} {}
+
+FramePipeline::~FramePipeline() {
+  drain();
+}
+
+void FramePipeline::run_frame() {
+  if (!primed_) {
+    prepare_(frame_, frame_ % kSlotCount, &counters_[frame_ % kSlotCount]);
+    primed_ = true;
+  }
+
+  const size_t slot = frame_ % kSlotCount;
+  const size_t next_slot = (frame_ + 1) % kSlotCount;
+
+  {
+    PROFILE_ZONE("FramePipeline::wait");
+    jobs_->wait(&counters_[slot]);
+  }
+
+  prepare_(frame_ + 1, next_slot, &counters_[next_slot]);
+
+  {
+    PROFILE_ZONE("FramePipeline::render");
+    render_(frame_, slot);
+  }
+
+  ++frame_;
+}
+
+void FramePipeline::drain() {
+  for (auto& counter : counters_) {
+    jobs_->wait(&counter);
+  }
+}
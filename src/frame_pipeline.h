@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "job_system.h"
+
+// Overlaps preparing the next frame with rendering the current one.
+//
+// Per-frame data (draw lists, instance transforms, ...) is double buffered in `kSlotCount` slots
+// owned by the caller.  `run_frame` waits for the jobs that prepared frame N, kicks off the jobs
+// that prepare frame N+1 into the other slot, then renders frame N on the calling thread, which
+// should be the one that owns the GL context.  Prepare jobs therefore run concurrently with
+// rendering and must not touch the slot being rendered or any GL state.
+//
+// A frame is shown one frame after it was prepared, which adds a frame of input latency.  That only
+// pays off when preparing a frame costs more than a frame, as in job-scaling-benchmark.  The app's
+// main loop simulates and draws a single sprite and samples input as late as it can, so it stays
+// serial.
+class FramePipeline {
+public:
+  static constexpr size_t kSlotCount = 2;
+
+  // Submits the jobs that prepare `frame` into `slot` to `jobs`, counted by `counter`, and returns
+  // without waiting for them.
+  using Prepare = std::function<void(uint64_t frame, size_t slot, JobCounter* counter)>;
+  // Renders `frame` from `slot`.
+  using Render = std::function<void(uint64_t frame, size_t slot)>;
+
+  FramePipeline(JobSystem* jobs, Prepare prepare, Render render);
+  // Waits for the frame that is still being prepared.
+  ~FramePipeline();
+
+  FramePipeline(const FramePipeline&) = delete;
+  FramePipeline& operator=(const FramePipeline&) = delete;
+
+  void run_frame();
+
+  // Waits for any jobs still preparing a frame.
+  void drain();
+
+  uint64_t frame() const {
+    return frame_;
+  }
+
+private:
+  JobSystem* jobs_;
+  Prepare prepare_;
+  Render render_;
+  JobCounter counters_[kSlotCount];
+  uint64_t frame_ = 0;
+  bool primed_ = false;
+};
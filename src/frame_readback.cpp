@@ -0,0 +1,101 @@
+#include "frame_readback.h"
+
+#include <cstring>
+
+#include "gl_error.h"
+
+FrameReadback::~FrameReadback() {
+  destroy();
+}
+
+bool FrameReadback::init(int width, int height) {
+  width_ = width;
+  height_ = height;
+
+  auto size = GLsizeiptr(width) * GLsizeiptr(height) * 4;
+  for (auto& slot : slots_) {
+    glGenBuffers(1, &slot.buffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  GLError();
+
+  return true;
+}
+
+void FrameReadback::destroy() {
+  for (auto& slot : slots_) {
+    if (slot.fence) {
+      glDeleteSync(slot.fence);
+      slot.fence = nullptr;
+    }
+    if (slot.buffer) {
+      glDeleteBuffers(1, &slot.buffer);
+      slot.buffer = 0;
+    }
+  }
+  next_ = 0;
+  pending_ = 0;
+}
+
+bool FrameReadback::read(uint64_t frame) {
+  if (pending_ == kBufferCount) {
+    return false;
+  }
+
+  Slot& slot = slots_[next_];
+  slot.frame = frame;
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 4);
+  glReadPixels(0, 0, width_, height_, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  GLError();
+
+  next_ = (next_ + 1) % kBufferCount;
+  ++pending_;
+
+  return true;
+}
+
+bool FrameReadback::collect(bool wait, Image* image, uint64_t* frame) {
+  if (pending_ == 0) {
+    return false;
+  }
+
+  Slot& slot = slots_[(next_ + kBufferCount - pending_) % kBufferCount];
+
+  GLuint64 timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+  GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+  if (status == GL_TIMEOUT_EXPIRED) {
+    return false;
+  }
+  glDeleteSync(slot.fence);
+  slot.fence = nullptr;
+
+  size_t row_size = size_t(width_) * 4;
+  image->width = width_;
+  image->height = height_;
+  image->pixels.resize(row_size * size_t(height_));
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+  auto* pixels = static_cast<const uint8_t*>(
+      glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(image->pixels.size()), GL_MAP_READ_BIT));
+  if (pixels) {
+    // OpenGL stores the bottom row first.
+    for (int y = 0; y < height_; ++y) {
+      std::memcpy(&image->pixels[size_t(y) * row_size],
+                  pixels + size_t(height_ - 1 - y) * row_size, row_size);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  GLError();
+
+  *frame = slot.frame;
+  --pending_;
+
+  return pixels != nullptr;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "image.h"
+
+// Reads rendered frames back to the CPU without stalling the pipeline.
+//
+// `read` starts an asynchronous glReadPixels of the bound read framebuffer into one of
+// `kBufferCount` pixel buffers and fences it.  The pixels are mapped by `collect` later, typically
+// while the next frame is being rendered, so the copy overlaps with rendering instead of waiting
+// for the GPU to finish.
+class FrameReadback {
+public:
+  static constexpr size_t kBufferCount = 2;
+
+  FrameReadback() = default;
+  ~FrameReadback();
+
+  FrameReadback(const FrameReadback&) = delete;
+  FrameReadback& operator=(const FrameReadback&) = delete;
+
+  bool init(int width, int height);
+  void destroy();
+
+  // Returns false if every buffer is still waiting to be collected.
+  bool read(uint64_t frame);
+
+  // Copies the oldest pending frame into `image` with the top row first.  If `wait` is false and
+  // the copy has not finished yet, returns false without blocking.
+  bool collect(bool wait, Image* image, uint64_t* frame);
+
+  size_t pending() const {
+    return pending_;
+  }
+
+private:
+  struct Slot {
+    GLuint buffer = 0;
+    GLsync fence = nullptr;
+    uint64_t frame = 0;
+  };
+
+  Slot slots_[kBufferCount];
+  size_t next_ = 0;
+  size_t pending_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+};
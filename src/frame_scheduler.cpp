@@ -0,0 +1,179 @@
+#include "frame_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "profiler.h"
+
+FrameTimeHistogram::FrameTimeHistogram() : buckets_(size_t(kMaxMs / kBucketMs) + 1) {}
+
+void FrameTimeHistogram::add(double ms) {
+  size_t bucket = std::min(size_t(std::max(ms, 0.0) / kBucketMs), buckets_.size() - 1);
+  ++buckets_[bucket];
+  ++count_;
+  total_ms_ += ms;
+  max_ms_ = std::max(max_ms_, ms);
+}
+
+void FrameTimeHistogram::clear() {
+  std::fill(buckets_.begin(), buckets_.end(), 0);
+  count_ = 0;
+  total_ms_ = 0.0;
+  max_ms_ = 0.0;
+}
+
+double FrameTimeHistogram::percentile(double fraction) const {
+  if (!count_) {
+    return 0.0;
+  }
+
+  auto rank = size_t(std::ceil(std::clamp(fraction, 0.0, 1.0) * double(count_)));
+  size_t seen = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    seen += buckets_[i];
+    if (seen >= std::max<size_t>(rank, 1)) {
+      return std::min(double(i + 1) * kBucketMs, max_ms_);
+    }
+  }
+
+  return max_ms_;
+}
+
+void FrameTimeHistogram::print_summary(std::ostream& out) const {
+  auto flags = out.flags();
+  auto precision = out.precision();
+  out << std::fixed << std::setprecision(2) << "frames " << count_ << ", mean " << mean()
+      << " ms, p50 " << percentile(0.5) << " ms, p90 " << percentile(0.9) << " ms, p99 "
+      << percentile(0.99) << " ms, max " << max() << " ms\n";
+  out.flags(flags);
+  out.precision(precision);
+}
+
+bool FrameTimeHistogram::write_csv(std::string_view path) const {
+  std::string p{path};
+
+  std::ofstream out{p};
+  out << "upper_ms,frames\n";
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    if (buckets_[i]) {
+      out << double(i + 1) * kBucketMs << ',' << buckets_[i] << '\n';
+    }
+  }
+  if (!out) {
+    std::cerr << "Could not write " << p << ".\n";
+    return false;
+  }
+
+  return true;
+}
+
+FrameScheduler::FrameScheduler(const FrameSchedulerConfig& config)
+    : config_{config},
+      step_seconds_{1.0 / config.simulation_hz},
+      fences_(std::max<size_t>(config.max_frames_in_flight, 1), nullptr) {}
+
+FrameScheduler::~FrameScheduler() {
+  destroy();
+}
+
+void FrameScheduler::destroy() {
+  for (auto& fence : fences_) {
+    if (fence) {
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+}
+
+void FrameScheduler::begin_frame() {
+  PROFILE_ZONE("FrameScheduler::begin_frame");
+
+  wait_for_gpu();
+  wait_for_cap();
+
+  Clock::time_point now = Clock::now();
+  double elapsed = 0.0;
+  if (started_) {
+    std::chrono::duration<double> interval = now - last_begin_;
+    frame_times_.add(interval.count() * 1000.0);
+    elapsed = interval.count();
+  }
+  if (config_.fixed_frame_seconds > 0.0) {
+    elapsed = config_.fixed_frame_seconds;
+  }
+  started_ = true;
+  last_begin_ = now;
+
+  accumulator_ += elapsed;
+  steps_ = int(accumulator_ / step_seconds_);
+  accumulator_ -= double(steps_) * step_seconds_;
+  if (steps_ > config_.max_steps_per_frame) {
+    steps_ = config_.max_steps_per_frame;
+  }
+}
+
+void FrameScheduler::end_frame() {
+  GLsync& fence = fences_[frame_ % fences_.size()];
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  // Make sure the fence reaches the GPU even if nothing else flushes before the next wait.
+  glFlush();
+  ++frame_;
+}
+
+void FrameScheduler::wait_for_gpu() {
+  GLsync& fence = fences_[frame_ % fences_.size()];
+  if (!fence) {
+    return;
+  }
+
+  // Only blocks if the GPU is still working on the frame from `max_frames_in_flight` frames ago.
+  GLenum result = glClientWaitSync(fence, 0, 0);
+  if (result == GL_TIMEOUT_EXPIRED) {
+    PROFILE_ZONE("FrameScheduler::wait_for_gpu");
+    auto start = Clock::now();
+    while (result == GL_TIMEOUT_EXPIRED) {
+      result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    fence_wait_ms_ += elapsed.count();
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void FrameScheduler::wait_for_cap() {
+  if (config_.max_fps <= 0.0) {
+    return;
+  }
+
+  const auto period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>{1.0 / config_.max_fps});
+  Clock::time_point now = Clock::now();
+  if (next_deadline_ > now) {
+    PROFILE_ZONE("FrameScheduler::wait_for_cap");
+    // Sleeping can overshoot by a millisecond or more, so sleep most of the way and yield for the
+    // rest.
+    constexpr std::chrono::milliseconds kSpinTime{2};
+    if (next_deadline_ - now > kSpinTime) {
+      std::this_thread::sleep_until(next_deadline_ - kSpinTime);
+    }
+    while (Clock::now() < next_deadline_) {
+      std::this_thread::yield();
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - now;
+    cap_wait_ms_ += elapsed.count();
+  }
+
+  // Keep a steady rate relative to the previous deadline, but after a long frame start over
+  // instead of rushing several frames out to catch up.
+  now = Clock::now();
+  next_deadline_ += period;
+  if (next_deadline_ < now) {
+    next_deadline_ = now + period;
+  }
+}
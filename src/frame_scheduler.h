@@ -0,0 +1,140 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+// Frame times in 0.1 ms buckets up to `kMaxMs`; longer frames share the last bucket.  The maximum
+// is kept exactly.
+class FrameTimeHistogram {
+public:
+  static constexpr double kBucketMs = 0.1;
+  static constexpr double kMaxMs = 250.0;
+
+  FrameTimeHistogram();
+
+  void add(double ms);
+  void clear();
+
+  size_t count() const {
+    return count_;
+  }
+
+  double mean() const {
+    return count_ ? total_ms_ / double(count_) : 0.0;
+  }
+
+  double max() const {
+    return max_ms_;
+  }
+
+  // Upper edge of the bucket holding the `fraction` (0..1) percentile.
+  double percentile(double fraction) const;
+
+  // One line with count, mean, p50, p90, p99 and max.
+  void print_summary(std::ostream& out) const;
+
+  // CSV with one "upper_ms,frames" row per non-empty bucket.
+  bool write_csv(std::string_view path) const;
+
+private:
+  std::vector<uint32_t> buckets_;
+  size_t count_ = 0;
+  double total_ms_ = 0.0;
+  double max_ms_ = 0.0;
+};
+
+struct FrameSchedulerConfig {
+  // The simulation always advances in steps of 1 / `simulation_hz` seconds.
+  double simulation_hz = 60.0;
+  // Frames per second to cap at; 0 leaves the rate to the swap interval.
+  double max_fps = 0.0;
+  // Frames the CPU may queue ahead of the GPU.  1 waits for the previous frame to finish on the
+  // GPU before starting the next, which gives the lowest input latency at some cost in throughput.
+  size_t max_frames_in_flight = 2;
+  // Caps the steps run in one frame so a long hitch does not turn into a spiral of ever longer
+  // frames.  Time beyond the cap is dropped.
+  int max_steps_per_frame = 8;
+  // When positive, every frame advances the simulation by exactly this many seconds instead of the
+  // measured frame time, so offline rendering is reproducible.
+  double fixed_frame_seconds = 0.0;
+};
+
+// Paces the main loop.
+//
+//   scheduler.begin_frame();           // waits for the frame cap and frames in flight
+//   ... sample input ...
+//   for (int i = 0; i < scheduler.steps(); ++i) simulate(scheduler.step_seconds());
+//   ... render, blending the last two simulation states by scheduler.alpha() ...
+//   ... swap ...
+//   scheduler.end_frame();             // fences the frame's GL commands
+//
+// The time between consecutive `begin_frame` calls is recorded in `frame_times()`.
+class FrameScheduler {
+public:
+  explicit FrameScheduler(const FrameSchedulerConfig& config = {});
+  ~FrameScheduler();
+
+  FrameScheduler(const FrameScheduler&) = delete;
+  FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+  void destroy();
+
+  void begin_frame();
+  void end_frame();
+
+  // Fixed steps to simulate this frame.
+  int steps() const {
+    return steps_;
+  }
+
+  double step_seconds() const {
+    return step_seconds_;
+  }
+
+  // How far (0..1) the current time is between the last two simulation states.
+  double alpha() const {
+    return accumulator_ / step_seconds_;
+  }
+
+  const FrameTimeHistogram& frame_times() const {
+    return frame_times_;
+  }
+
+  // Total time `begin_frame` spent waiting for the GPU to catch up.
+  double fence_wait_ms() const {
+    return fence_wait_ms_;
+  }
+
+  // Total time `begin_frame` spent waiting for the frame cap.
+  double cap_wait_ms() const {
+    return cap_wait_ms_;
+  }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  void wait_for_gpu();
+  void wait_for_cap();
+
+  FrameSchedulerConfig config_;
+  double step_seconds_;
+
+  std::vector<GLsync> fences_;
+  uint64_t frame_ = 0;
+
+  bool started_ = false;
+  Clock::time_point last_begin_;
+  Clock::time_point next_deadline_;
+  double accumulator_ = 0.0;
+  int steps_ = 0;
+
+  FrameTimeHistogram frame_times_;
+  double fence_wait_ms_ = 0.0;
+  double cap_wait_ms_ = 0.0;
+};
@@ -0,0 +1,129 @@
+#include "gl_error.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+#if defined(WIN32)
+#include <windows.h>
+#endif
+
+namespace {
+
+bool debug_output_enabled = false;
+
+const char* debug_type_name(GLenum type) {
+  switch (type) {
+    case GL_DEBUG_TYPE_ERROR:
+      return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+      return "deprecated behavior";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+      return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:
+      return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:
+      return "performance";
+    default:
+      return "message";
+  }
+}
+
+const char* debug_severity_name(GLenum severity) {
+  switch (severity) {
+    case GL_DEBUG_SEVERITY_HIGH:
+      return "high";
+    case GL_DEBUG_SEVERITY_MEDIUM:
+      return "medium";
+    case GL_DEBUG_SEVERITY_LOW:
+      return "low";
+    default:
+      return "notification";
+  }
+}
+
+void GLAPIENTRY debug_message(GLenum, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                              const GLchar* message, const void*) {
+  std::cerr << "OpenGL " << debug_type_name(type) << " (" << debug_severity_name(severity)
+            << ", id " << id << "): "
+            << (length >= 0 ? std::string_view(message, size_t(length)) : std::string_view(message))
+            << '\n';
+
+#if !defined(NDEBUG)
+  if (type == GL_DEBUG_TYPE_ERROR) {
+#if defined(WIN32)
+    __debugbreak();
+#endif
+    std::exit(1);
+  }
+#endif
+}
+
+}  // namespace
+
+void GLError() {
+#if !defined(NDEBUG)
+  if (debug_output_enabled) {
+    return;
+  }
+
+  auto error = glGetError();
+
+  if (error != GL_NO_ERROR) {
+    std::cerr << "OpenGL error: ";
+
+    switch (error) {
+      case GL_INVALID_OPERATION:
+        std::cerr << "Invalid operation.";
+        break;
+
+      default:
+        std::cerr << error << " (" << std::hex << error << ')';
+    }
+    std::cerr << '\n';
+#if defined(WIN32)
+    __debugbreak();
+#endif
+    std::exit(1);
+  }
+#endif
+}
+
+bool enable_debug_output() {
+  if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+    return false;
+  }
+
+  glEnable(GL_DEBUG_OUTPUT);
+#if !defined(NDEBUG)
+  // Deliver messages inside the offending call, so the callback's stack points at it.
+  glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+#endif
+  glDebugMessageCallback(debug_message, nullptr);
+  glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                        GL_FALSE);
+
+  debug_output_enabled = true;
+
+  return true;
+}
+
+bool init_glew(bool headless) {
+  // Core profile contexts need this for GLEW to load entry points it finds through
+  // glGetStringi rather than glGetString(GL_EXTENSIONS).
+  glewExperimental = GL_TRUE;
+  GLenum err = glewInit();
+  // GLEW built for GLX loads the GL entry points first and only then fails because an EGL
+  // context has no GLX display.
+#if defined(GLEW_ERROR_NO_GLX_DISPLAY)
+  if (headless && err == GLEW_ERROR_NO_GLX_DISPLAY) {
+    err = GLEW_OK;
+  }
+#else
+  (void)headless;
+#endif
+  // glewInit may leave GL_INVALID_ENUM behind on core profiles.
+  glGetError();
+
+  return err == GLEW_OK;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Checks `glGetError` in debug builds and aborts on any error.  Does nothing once debug output is
+// enabled, since the driver then reports errors itself.
+void GLError();
+
+// Reports driver errors and warnings through a KHR_debug message callback (core in OpenGL 4.3)
+// instead of polling `glGetError` after every call.  Errors abort in debug builds, as with
+// `GLError`.  Returns false if the context does not support debug output.
+bool enable_debug_output();
+
+// Loads the GL entry points for the current context with GLEW and clears the error GLEW leaves
+// behind on core profiles.  Pass `headless` for EGL contexts.
+bool init_glew(bool headless);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a.  Used for content hashes in asset packs and caches, not for security.
+inline uint64_t fnv1a_64(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+  auto* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+inline uint64_t fnv1a_64(std::string_view str) {
+  return fnv1a_64(str.data(), str.size());
+}
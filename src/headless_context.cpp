@@ -0,0 +1,153 @@
+#include "headless_context.h"
+
+#include <iostream>
+
+#if defined(CORE_GRAPHICS_HAS_EGL)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#endif
+
+HeadlessContext::~HeadlessContext() {
+  destroy();
+}
+
+#if defined(CORE_GRAPHICS_HAS_EGL)
+
+namespace {
+
+bool has_extension(const char* extensions, const char* name) {
+  if (!extensions) {
+    return false;
+  }
+
+  size_t length = std::strlen(name);
+  for (const char* p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+    bool starts = p == extensions || p[-1] == ' ';
+    bool ends = p[length] == ' ' || p[length] == '\0';
+    if (starts && ends) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+EGLDisplay open_display() {
+  const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+
+  if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+    auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (get_platform_display) {
+      EGLDisplay display =
+          get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+      if (display != EGL_NO_DISPLAY) {
+        return display;
+      }
+    }
+  }
+
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+}  // namespace
+
+bool HeadlessContext::init(int major_version, int minor_version) {
+  EGLDisplay display = open_display();
+  if (display == EGL_NO_DISPLAY) {
+    std::cerr << "Could not get an EGL display.\n";
+    return false;
+  }
+
+  EGLint major = 0;
+  EGLint minor = 0;
+  if (!eglInitialize(display, &major, &minor)) {
+    std::cerr << "Could not initialize EGL.\n";
+    return false;
+  }
+  display_ = display;
+
+  if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+    std::cerr << "EGL " << major << "." << minor << " does not support surfaceless contexts.\n";
+    destroy();
+    return false;
+  }
+
+  if (!eglBindAPI(EGL_OPENGL_API)) {
+    std::cerr << "EGL does not support desktop OpenGL.\n";
+    destroy();
+    return false;
+  }
+
+  // No surface is ever created, but the default surface type (window) rules out every config on
+  // the surfaceless platform.
+  const EGLint config_attributes[] = {
+      EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_RED_SIZE,  8,
+      EGL_GREEN_SIZE,   8,               EGL_BLUE_SIZE,       8,              EGL_ALPHA_SIZE, 8,
+      EGL_NONE,
+  };
+  EGLConfig config = nullptr;
+  EGLint config_count = 0;
+  if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) ||
+      config_count == 0) {
+    std::cerr << "Could not find an EGL config.\n";
+    destroy();
+    return false;
+  }
+
+  const EGLint context_attributes[] = {
+      EGL_CONTEXT_MAJOR_VERSION,
+      major_version,
+      EGL_CONTEXT_MINOR_VERSION,
+      minor_version,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if !defined(NDEBUG)
+      EGL_CONTEXT_OPENGL_DEBUG,
+      EGL_TRUE,
+#endif
+      EGL_NONE,
+  };
+  EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+  if (context == EGL_NO_CONTEXT) {
+    std::cerr << "Could not create an OpenGL " << major_version << "." << minor_version
+              << " context.\n";
+    destroy();
+    return false;
+  }
+  context_ = context;
+
+  if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    std::cerr << "Could not make the headless context current.\n";
+    destroy();
+    return false;
+  }
+
+  return true;
+}
+
+void HeadlessContext::destroy() {
+  if (!display_) {
+    return;
+  }
+
+  eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (context_) {
+    eglDestroyContext(display_, context_);
+    context_ = nullptr;
+  }
+  eglTerminate(display_);
+  display_ = nullptr;
+}
+
+#else
+
+bool HeadlessContext::init(int, int) {
+  std::cerr << "Headless rendering needs EGL, which was not found at build time.\n";
+  return false;
+}
+
+void HeadlessContext::destroy() {}
+
+#endif
@@ -0,0 +1,22 @@
+#pragma once
+
+// OpenGL core profile context without a window or display, for rendering on machines with no
+// window system (e.g. Mesa llvmpipe on a CPU node).  Uses EGL with the surfaceless platform when
+// available and the default display otherwise.  Nothing is bound to the default framebuffer, so
+// render into a `RenderTarget`.
+class HeadlessContext {
+public:
+  HeadlessContext() = default;
+  ~HeadlessContext();
+
+  HeadlessContext(const HeadlessContext&) = delete;
+  HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+  // Creates the context and makes it current on the calling thread.
+  bool init(int major_version, int minor_version);
+  void destroy();
+
+private:
+  void* display_ = nullptr;
+  void* context_ = nullptr;
+};
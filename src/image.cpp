@@ -0,0 +1,128 @@
+#include "image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+bool load_image(std::string_view path, Image* image) {
+  std::string p{path};
+
+  int channels = 0;
+  auto* data = stbi_load(p.c_str(), &image->width, &image->height, &channels, 4);
+  if (!data) {
+    std::cerr << "Could not load image " << p << ".\n";
+    return false;
+  }
+
+  image->pixels.resize(size_t(image->width) * size_t(image->height) * 4);
+  std::memcpy(image->pixels.data(), data, image->pixels.size());
+
+  stbi_image_free(data);
+
+  return true;
+}
+
+bool decode_image(const uint8_t* data, size_t size, Image* image) {
+  int channels = 0;
+  auto* decoded =
+      stbi_load_from_memory(data, int(size), &image->width, &image->height, &channels, 4);
+  if (!decoded) {
+    return false;
+  }
+
+  image->pixels.resize(size_t(image->width) * size_t(image->height) * 4);
+  std::memcpy(image->pixels.data(), decoded, image->pixels.size());
+
+  stbi_image_free(decoded);
+
+  return true;
+}
+
+Image half_size(const Image& image) {
+  Image half;
+  half.width = std::max(image.width / 2, 1);
+  half.height = std::max(image.height / 2, 1);
+  half.pixels.resize(size_t(half.width) * size_t(half.height) * 4);
+
+  for (int y = 0; y < half.height; ++y) {
+    int y0 = std::min(y * 2, image.height - 1);
+    int y1 = std::min(y * 2 + 1, image.height - 1);
+    for (int x = 0; x < half.width; ++x) {
+      int x0 = std::min(x * 2, image.width - 1);
+      int x1 = std::min(x * 2 + 1, image.width - 1);
+      for (int c = 0; c < 4; ++c) {
+        auto texel = [&image, c](int tx, int ty) {
+          return unsigned(image.pixels[(size_t(ty) * image.width + tx) * 4 + c]);
+        };
+        unsigned sum = texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1);
+        half.pixels[(size_t(y) * half.width + x) * 4 + c] = uint8_t((sum + 2) / 4);
+      }
+    }
+  }
+
+  return half;
+}
+
+bool write_png(std::string_view path, const Image& image) {
+  std::string p{path};
+
+  if (!stbi_write_png(p.c_str(), image.width, image.height, 4, image.pixels.data(),
+                      image.width * 4)) {
+    std::cerr << "Could not write image " << p << ".\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool write_raw(std::string_view path, const Image& image) {
+  std::string p{path};
+
+  std::ofstream out{p, std::ios::binary};
+  out.write(reinterpret_cast<const char*>(image.pixels.data()),
+            std::streamsize(image.pixels.size()));
+  if (!out) {
+    std::cerr << "Could not write image " << p << ".\n";
+    return false;
+  }
+
+  return true;
+}
+
+bool compare_images(const Image& a, const Image& b, int tolerance, ImageDifference* difference) {
+  *difference = {};
+  if (a.width != b.width || a.height != b.height || a.pixels.size() != b.pixels.size()) {
+    return false;
+  }
+
+  double squared_error = 0.0;
+  for (size_t i = 0; i < a.pixels.size(); i += 4) {
+    int pixel_error = 0;
+    for (size_t c = 0; c < 4; ++c) {
+      int error = std::abs(int(a.pixels[i + c]) - int(b.pixels[i + c]));
+      pixel_error = std::max(pixel_error, error);
+      squared_error += double(error * error);
+    }
+    difference->max_error = std::max(difference->max_error, pixel_error);
+    if (pixel_error > tolerance) {
+      ++difference->mismatched_pixels;
+    }
+  }
+
+  double mean_squared_error = squared_error / double(a.pixels.size());
+  difference->psnr = mean_squared_error > 0.0
+                         ? 10.0 * std::log10(255.0 * 255.0 / mean_squared_error)
+                         : std::numeric_limits<double>::infinity();
+
+  return true;
+}
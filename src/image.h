@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Decoded RGBA8 image data.
+struct Image {
+  int width = 0;
+  int height = 0;
+  std::vector<uint8_t> pixels;
+};
+
+// Decodes the image at `path` to RGBA8.  Safe to call from any thread.
+bool load_image(std::string_view path, Image* image);
+
+// Decodes an encoded image (PNG, JPEG, ...) held in memory to RGBA8.
+bool decode_image(const uint8_t* data, size_t size, Image* image);
+
+// Box filters `image` to half its size, at least 1x1.  Odd edges repeat the last row or column.
+Image half_size(const Image& image);
+
+// Writes RGBA8 pixels as a PNG.
+bool write_png(std::string_view path, const Image& image);
+
+// Writes the RGBA8 pixels as they are, without any header.
+bool write_raw(std::string_view path, const Image& image);
+
+struct ImageDifference {
+  // Largest difference of any channel, 0..255.
+  int max_error = 0;
+  // Pixels where some channel differs by more than the tolerance.
+  size_t mismatched_pixels = 0;
+  // Peak signal to noise ratio in dB; infinite for identical images.
+  double psnr = 0.0;
+};
+
+// Compares two images of the same size.  Returns false if the sizes differ.
+bool compare_images(const Image& a, const Image& b, int tolerance, ImageDifference* difference);
@@ -0,0 +1,84 @@
+#include "image_decode_pool.h"
+
+#include <algorithm>
+
+ImageDecodePool::ImageDecodePool(size_t worker_count) {
+  if (worker_count == 0) {
+    worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  }
+
+  workers_.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back(&ImageDecodePool::worker_main, this);
+  }
+}
+
+ImageDecodePool::~ImageDecodePool() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+std::shared_ptr<DecodeRequest> ImageDecodePool::submit(std::string path) {
+  auto request = std::make_shared<DecodeRequest>();
+  request->path = std::move(path);
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    queue_.push_back(request);
+    ++in_flight_;
+  }
+  work_available_.notify_one();
+
+  return request;
+}
+
+void ImageDecodePool::pop_completed(std::vector<std::shared_ptr<DecodeRequest>>* out) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  out->insert(out->end(), completed_.begin(), completed_.end());
+  completed_.clear();
+}
+
+void ImageDecodePool::wait_idle() {
+  std::unique_lock<std::mutex> lock{mutex_};
+  idle_.wait(lock, [this] {
+    return in_flight_ == 0;
+  });
+}
+
+void ImageDecodePool::worker_main() {
+  for (;;) {
+    std::shared_ptr<DecodeRequest> request;
+
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      work_available_.wait(lock, [this] {
+        return stopping_ || !queue_.empty();
+      });
+      if (stopping_) {
+        return;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    bool decoded = load_image(request->path, &request->image);
+    request->state =
+        decoded ? DecodeRequest::State::kDecoded : DecodeRequest::State::kFailed;
+
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      completed_.push_back(std::move(request));
+      --in_flight_;
+      if (in_flight_ == 0) {
+        idle_.notify_all();
+      }
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "image.h"
+
+struct DecodeRequest {
+  enum class State {
+    kQueued,
+    kDecoded,
+    kFailed,
+  };
+
+  std::string path;
+  Image image;
+  std::atomic<State> state{State::kQueued};
+};
+
+// Decodes images on a set of worker threads.  Finished requests are collected with
+// `pop_completed`, which never blocks.
+class ImageDecodePool {
+public:
+  // A `worker_count` of 0 uses one thread less than the number of hardware threads.
+  explicit ImageDecodePool(size_t worker_count = 0);
+  ~ImageDecodePool();
+
+  ImageDecodePool(const ImageDecodePool&) = delete;
+  ImageDecodePool& operator=(const ImageDecodePool&) = delete;
+
+  std::shared_ptr<DecodeRequest> submit(std::string path);
+
+  // Moves all requests that finished decoding (successfully or not) into `out`.
+  void pop_completed(std::vector<std::shared_ptr<DecodeRequest>>* out);
+
+  // Blocks until every submitted request has finished decoding.
+  void wait_idle();
+
+  size_t worker_count() const {
+    return workers_.size();
+  }
+
+private:
+  void worker_main();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable idle_;
+  std::deque<std::shared_ptr<DecodeRequest>> queue_;
+  std::vector<std::shared_ptr<DecodeRequest>> completed_;
+  size_t in_flight_ = 0;
+  bool stopping_ = false;
+};
@@ -0,0 +1,162 @@
+#include "indirect_renderer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include "gl_error.h"
+#include "mesh.h"
+#include "profiler.h"
+
+IndirectRenderer::~IndirectRenderer() {
+  destroy();
+}
+
+bool IndirectRenderer::init(const MeshPool& pool, size_t max_instances, size_t max_materials) {
+  max_instances_ = max_instances;
+  max_materials_ = max_materials;
+
+  glGenVertexArrays(1, &vertex_array_object_);
+  glBindVertexArray(vertex_array_object_);
+
+  glBindBuffer(GL_ARRAY_BUFFER, pool.vertex_buffer());
+  set_vertex_attributes();
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.index_buffer());
+
+  std::vector<uint32_t> ids(max_instances);
+  std::iota(ids.begin(), ids.end(), 0);
+
+  glGenBuffers(1, &instance_id_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_id_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(ids.size() * sizeof(uint32_t)), ids.data(),
+               GL_STATIC_DRAW);
+  glEnableVertexAttribArray(3);
+  glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(uint32_t), nullptr);
+  glVertexAttribDivisor(3, 1);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glGenBuffers(1, &instance_buffer_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(max_instances * sizeof(InstanceData)), nullptr,
+               GL_DYNAMIC_DRAW);
+
+  glGenBuffers(1, &material_buffer_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, material_buffer_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(max_materials * sizeof(glm::vec4)), nullptr,
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  // Worst case is one command per instance.
+  glGenBuffers(1, &indirect_buffer_);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER,
+               GLsizeiptr(max_instances * sizeof(DrawElementsIndirectCommand)), nullptr,
+               GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+  GLError();
+
+  return true;
+}
+
+void IndirectRenderer::destroy() {
+  GLuint buffers[] = {instance_id_buffer_, instance_buffer_, material_buffer_, indirect_buffer_};
+  if (buffers[0]) {
+    glDeleteBuffers(4, buffers);
+  }
+  instance_id_buffer_ = 0;
+  instance_buffer_ = 0;
+  material_buffer_ = 0;
+  indirect_buffer_ = 0;
+
+  if (vertex_array_object_) {
+    glDeleteVertexArrays(1, &vertex_array_object_);
+    vertex_array_object_ = 0;
+  }
+}
+
+void IndirectRenderer::set_materials(const glm::vec4* colors, size_t count) {
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, material_buffer_);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                  GLsizeiptr(std::min(count, max_materials_) * sizeof(glm::vec4)), colors);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  GLError();
+}
+
+void IndirectRenderer::add_instances(const uint32_t* visible, size_t count,
+                                     const MeshHandle* meshes, const glm::mat4* transforms,
+                                     const uint32_t* materials) {
+  instances_.reserve(instances_.size() + count);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t object = visible[i];
+    add_instance(meshes[object], transforms[object], materials[object]);
+  }
+}
+
+void IndirectRenderer::add_draw_list(const DrawList& list) {
+  for (const auto& item : list.items()) {
+    add_instance(item.mesh, item.transform, item.material);
+  }
+}
+
+void IndirectRenderer::draw(GLuint program) {
+  PROFILE_ZONE("IndirectRenderer::draw");
+  PROFILE_GPU_ZONE("IndirectRenderer::draw");
+
+  stats_ = {};
+
+  if (instances_.size() > max_instances_) {
+    std::cerr << "Dropping " << instances_.size() - max_instances_ << " instances.\n";
+    instances_.resize(max_instances_);
+  }
+  stats_.instances = instances_.size();
+
+  if (instances_.empty()) {
+    return;
+  }
+
+  std::stable_sort(instances_.begin(), instances_.end(),
+                   [](const PendingInstance& a, const PendingInstance& b) {
+                     return a.mesh.first_index < b.mesh.first_index;
+                   });
+
+  instance_data_.clear();
+  commands_.clear();
+  for (const auto& instance : instances_) {
+    if (commands_.empty() || commands_.back().first_index != instance.mesh.first_index) {
+      commands_.push_back({instance.mesh.index_count, 0, instance.mesh.first_index,
+                           instance.mesh.base_vertex, uint32_t(instance_data_.size())});
+    }
+    ++commands_.back().instance_count;
+    instance_data_.push_back(instance.data);
+  }
+  stats_.commands = commands_.size();
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, instance_buffer_);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                  GLsizeiptr(instance_data_.size() * sizeof(InstanceData)), instance_data_.data());
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+  glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0,
+                  GLsizeiptr(commands_.size() * sizeof(DrawElementsIndirectCommand)),
+                  commands_.data());
+
+  glUseProgram(program);
+  glBindVertexArray(vertex_array_object_);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instance_buffer_);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, material_buffer_);
+
+  glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, GLsizei(commands_.size()),
+                              0);
+  GLError();
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+  PROFILE_COUNT(kDrawCalls, 1);
+  PROFILE_COUNT(kStateChanges, 4);
+  PROFILE_COUNT(kBufferUploads, 2);
+  PROFILE_COUNT(kUploadBytes, instance_data_.size() * sizeof(InstanceData) +
+                                  commands_.size() * sizeof(DrawElementsIndirectCommand));
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "draw_list.h"
+#include "mesh_pool.h"
+
+// Per-instance data as laid out in the `Instances` storage block (std430) of the indirect shaders.
+struct InstanceData {
+  glm::mat4 transform;
+  uint32_t material;
+  uint32_t padding[3];
+};
+
+// Matches the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand {
+  uint32_t count;
+  uint32_t instance_count;
+  uint32_t first_index;
+  int32_t base_vertex;
+  uint32_t base_instance;
+};
+
+struct IndirectStats {
+  size_t instances = 0;
+  size_t commands = 0;
+};
+
+// Draws every instance of every mesh in a `MeshPool` with a single glMultiDrawElementsIndirect.
+//
+// Instance transforms and material indices live in a shader storage buffer (binding 0) and
+// material colors in another (binding 1).  The instance index reaches the vertex shader through
+// attribute 3, an instanced attribute over 0..max_instances-1 that honours `base_instance`.  This
+// avoids needing gl_BaseInstance / gl_DrawID, which are not core in OpenGL 4.3.
+class IndirectRenderer {
+public:
+  IndirectRenderer() = default;
+  ~IndirectRenderer();
+
+  IndirectRenderer(const IndirectRenderer&) = delete;
+  IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+  bool init(const MeshPool& pool, size_t max_instances, size_t max_materials);
+  void destroy();
+
+  void set_materials(const glm::vec4* colors, size_t count);
+
+  void clear() {
+    instances_.clear();
+  }
+
+  void add_instance(const MeshHandle& mesh, const glm::mat4& transform, uint32_t material) {
+    instances_.push_back({mesh, {transform, material, {}}});
+  }
+
+  // Adds the objects listed in `visible` (e.g. from `TransformStage::cull_boxes`), looking up
+  // their mesh, transform and material in per-object arrays.
+  void add_instances(const uint32_t* visible, size_t count, const MeshHandle* meshes,
+                     const glm::mat4* transforms, const uint32_t* materials);
+
+  // Adds every draw recorded in `list`.
+  void add_draw_list(const DrawList& list);
+
+  // Uploads the instances added since the last `clear` and draws them.  Instances are grouped by
+  // mesh, one indirect command per mesh.
+  void draw(GLuint program);
+
+  const IndirectStats& last_stats() const {
+    return stats_;
+  }
+
+private:
+  struct PendingInstance {
+    MeshHandle mesh;
+    InstanceData data;
+  };
+
+  std::vector<PendingInstance> instances_;
+  std::vector<InstanceData> instance_data_;
+  std::vector<DrawElementsIndirectCommand> commands_;
+  IndirectStats stats_;
+
+  size_t max_instances_ = 0;
+  size_t max_materials_ = 0;
+  GLuint vertex_array_object_ = 0;
+  GLuint instance_id_buffer_ = 0;
+  GLuint instance_buffer_ = 0;
+  GLuint material_buffer_ = 0;
+  GLuint indirect_buffer_ = 0;
+};
@@ -0,0 +1,159 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+// Identifies the job system a worker thread belongs to, and its queue.
+thread_local const JobSystem* worker_owner = nullptr;
+thread_local size_t worker_queue = 0;
+
+}  // namespace
+
+JobSystem::JobSystem(size_t thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  // Queue 0 is shared by every thread that is not a worker.
+  queues_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+
+  workers_.reserve(thread_count - 1);
+  for (size_t i = 1; i < thread_count; ++i) {
+    workers_.emplace_back(&JobSystem::worker_main, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  // Finish everything that was submitted, including jobs those jobs submit, so no counter is left
+  // waiting on a job that will never run.
+  while (unfinished_.load(std::memory_order_acquire) > 0) {
+    if (!run_one(0)) {
+      std::this_thread::yield();
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t JobSystem::current_queue() const {
+  return worker_owner == this ? worker_queue : 0;
+}
+
+void JobSystem::submit(Job job, JobCounter* counter) {
+  assert(!stopping_ && "submit while the job system is being destroyed");
+
+  unfinished_.fetch_add(1, std::memory_order_relaxed);
+  if (counter) {
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Queue& queue = *queues_[current_queue()];
+  {
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.tasks.push_back({std::move(job), counter});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    ++queued_;
+  }
+  work_available_.notify_one();
+}
+
+void JobSystem::parallel_for(size_t count, size_t grain, std::function<void(size_t, size_t)> body,
+                             JobCounter* counter) {
+  grain = std::max<size_t>(grain, 1);
+
+  // Shared so every chunk can refer to the one copy of `body`.
+  auto shared_body = std::make_shared<std::function<void(size_t, size_t)>>(std::move(body));
+  for (size_t first = 0; first < count; first += grain) {
+    size_t last = std::min(first + grain, count);
+    submit([shared_body, first, last]() { (*shared_body)(first, last); }, counter);
+  }
+}
+
+void JobSystem::wait(JobCounter* counter) {
+  assert(!stopping_ && "wait while the job system is being destroyed");
+
+  size_t queue = current_queue();
+  while (!counter->done()) {
+    if (!run_one(queue)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+bool JobSystem::pop_own(size_t queue, Task* task) {
+  Queue& own = *queues_[queue];
+  std::lock_guard<std::mutex> lock{own.mutex};
+  if (own.tasks.empty()) {
+    return false;
+  }
+
+  *task = std::move(own.tasks.back());
+  own.tasks.pop_back();
+  return true;
+}
+
+bool JobSystem::steal(size_t thief, Task* task) {
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    Queue& victim = *queues_[(thief + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock{victim.mutex};
+    if (!victim.tasks.empty()) {
+      *task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool JobSystem::run_one(size_t queue) {
+  Task task;
+  if (!pop_own(queue, &task) && !steal(queue, &task)) {
+    return false;
+  }
+  --queued_;
+
+  task.job();
+
+  if (task.counter) {
+    task.counter->pending.fetch_sub(1, std::memory_order_release);
+  }
+  unfinished_.fetch_sub(1, std::memory_order_release);
+
+  return true;
+}
+
+void JobSystem::worker_main(size_t queue) {
+  worker_owner = this;
+  worker_queue = queue;
+
+  for (;;) {
+    if (run_one(queue)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{sleep_mutex_};
+    work_available_.wait(lock, [this] {
+      return stopping_ || queued_ > 0;
+    });
+    if (stopping_) {
+      return;
+    }
+  }
+}
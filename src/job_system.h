@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts unfinished jobs.  Jobs submitted with a counter decrement it when they finish.
+struct JobCounter {
+  std::atomic<size_t> pending{0};
+
+  bool done() const {
+    return pending.load(std::memory_order_acquire) == 0;
+  }
+};
+
+// Work-stealing job system.
+//
+// Every worker thread owns a deque.  Jobs submitted from a worker go to the back of its own deque
+// and the worker takes jobs from the back as well, so related work stays on one core while it is
+// hot in cache.  A worker with nothing left steals from the front of another worker's deque.  Jobs
+// submitted from other threads go to a shared deque that all workers steal from.
+//
+// `wait` does not block while there is work: the waiting thread runs jobs until the counter
+// reaches zero, so the thread that submits a frame's jobs helps finish them.
+class JobSystem {
+public:
+  using Job = std::function<void()>;
+
+  // A `thread_count` of 0 uses one worker per hardware thread, minus the calling thread.  With
+  // `thread_count` 1 all jobs run on the thread that waits for them.
+  explicit JobSystem(size_t thread_count = 0);
+  // Runs every job still queued before stopping the workers.  No other thread may submit or wait
+  // once destruction has started.
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  void submit(Job job, JobCounter* counter);
+
+  // Runs `body(first, last)` over [0, count) in chunks of `grain` items.
+  void parallel_for(size_t count, size_t grain, std::function<void(size_t, size_t)> body,
+                    JobCounter* counter);
+
+  // Runs jobs until `counter` reaches zero.
+  void wait(JobCounter* counter);
+
+  // Worker threads plus the thread that waits.
+  size_t thread_count() const {
+    return workers_.size() + 1;
+  }
+
+private:
+  struct Task {
+    Job job;
+    JobCounter* counter;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Index of the calling thread's queue; 0 is the shared queue for non-worker threads.
+  size_t current_queue() const;
+
+  bool pop_own(size_t queue, Task* task);
+  bool steal(size_t thief, Task* task);
+  bool run_one(size_t queue);
+  void worker_main(size_t queue);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable work_available_;
+  std::atomic<long> queued_{0};
+  // Jobs submitted but not yet finished, including the ones running.
+  std::atomic<long> unfinished_{0};
+  std::atomic<bool> stopping_{false};
+};
@@ -6,227 +6,147 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
-constexpr int DISPLAY_WIDTH = 1600;
-constexpr int DISPLAY_HEIGHT = 900;
-
-void GLError() {
-#if !defined(NDEBUG)
-  auto error = glGetError();
-
-  if (error != GL_NO_ERROR) {
-    std::cerr << "OpenGL error: ";
-
-    switch (error) {
-      case GL_INVALID_OPERATION:
-        std::cerr << "Invalid operation.";
-        break;
-
-      default:
-        std::cerr << error << " (" << std::hex << error << ')';
-    }
-    std::cerr << '\n';
-#if defined(WIN32)
-    __debugbreak();
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asset_loader.h"
+#include "asset_pack.h"
+#include "batch_renderer.h"
+#include "frame_readback.h"
+#include "frame_scheduler.h"
+#include "gl_error.h"
+#include "headless_context.h"
+#include "mesh.h"
+#include "profiler.h"
+#include "render_target.h"
+#include "shader_cache.h"
+#include "texture.h"
+#include "texture_compression.h"
+#include "vertex.h"
+
+#if !defined(CORE_GRAPHICS_RESOURCES_DIR)
+#define CORE_GRAPHICS_RESOURCES_DIR "resources"
 #endif
-    std::exit(1);
-  }
-#endif
-}
-
-const char* kVertexShader = R"(
-#version 430
-
-layout(location = 0) in vec3 in_position;
-layout(location = 1) in vec4 in_color;
-layout(location = 2) in vec2 in_tex_coord;
-
-out vec4 vertex_color;
-out vec2 vertex_tex_coord;
-
-uniform mat4 u_projection_matrix;
-uniform mat4 u_view_matrix;
-uniform mat4 u_model_matrix;
-
-void main() {
-  gl_Position = u_projection_matrix * u_view_matrix * vec4(in_position, 1.0);
-  vertex_color = in_color;
-  vertex_tex_coord = in_tex_coord;
-}
-)";
-
-const char* kFragmentShader = R"(
-#version 430
 
-in vec4 vertex_color;
-in vec2 vertex_tex_coord;
-
-out vec4 frag_color;
-
-uniform sampler2D u_texture;
-
-void main () {
-  vec4 color = texture(u_texture, vertex_tex_coord);
-  frag_color = color;
-  // frag_color = vec4(vertex_color);
-}
-)";
-
-struct Vertex {
-  glm::vec3 position;
-  glm::vec4 color;
-  glm::vec2 tex_coords;
-};
-
-struct Mesh {
-  GLuint vertex_array_object;
-  GLsizei vertex_count;
-
-  ~Mesh() {
-    glDeleteVertexArrays(1, &vertex_array_object);
-  }
-};
-
-Mesh create_mesh(Vertex* vertices, size_t count) {
-  GLuint vao;
-  glGenVertexArrays(1, &vao);
-  glBindVertexArray(vao);
-
-  // Create the vertex buffer.
-  GLuint vertex_buffer;
-  glGenBuffers(1, &vertex_buffer);
-  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-  glBufferData(GL_ARRAY_BUFFER, GLuint(count * sizeof(Vertex)), vertices, GL_STATIC_DRAW);
-
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
-
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(float) * 3));
-
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(float) * 7));
+#if !defined(CORE_GRAPHICS_ASSET_PACK)
+#define CORE_GRAPHICS_ASSET_PACK "resources.pack"
+#endif
 
-  glBindVertexArray(0);
+#if !defined(CORE_GRAPHICS_SHADER_CACHE_DIR)
+#define CORE_GRAPHICS_SHADER_CACHE_DIR "shader_cache"
+#endif
 
-  return {
-      vao,
-      (GLsizei)count,
-  };
-}
+constexpr int DISPLAY_WIDTH = 1600;
+constexpr int DISPLAY_HEIGHT = 900;
 
-struct Texture {
-  GLuint texture_id;
-  int width;
-  int height;
+constexpr size_t kDefaultHeadlessFrames = 60;
+
+constexpr double kSimulationHz = 60.0;
+
+struct Options {
+  bool headless = false;
+  // Number of frames to render; 0 renders until the window is closed.
+  size_t frames = 0;
+  // Directory to write rendered frames to (headless only).  Nothing is written when empty.
+  std::string output_dir;
+  // Chrome trace written on exit when built with CORE_GRAPHICS_PROFILING.
+  std::string trace_path;
+  bool raw = false;
+  // Compress the texture to this format at load time instead of uploading RGBA8.
+  bool compress = false;
+  BlockFormat texture_format = BlockFormat::kBC1;
+  // Pack the sprite into a mipmapped atlas page instead of giving it a texture of its own.
+  bool atlas = false;
+  // Frame pacing.  A negative swap interval keeps the driver default.
+  double fps_cap = 0.0;
+  int swap_interval = -1;
+  size_t frames_in_flight = 2;
+  // Sample input again right before submitting the frame.
+  bool late_input = false;
+  // Frame time histogram written on exit as CSV.
+  std::string frame_times_path;
+  int width = DISPLAY_WIDTH;
+  int height = DISPLAY_HEIGHT;
 };
 
-Texture load_texture(std::string_view path) {
-  Texture result{};
-
-  int channels = 0;
-  auto* image = stbi_load(path.data(), &result.width, &result.height, &channels, 4);
-
-  std::cout << "Image: width(" << result.width << "), height(" << result.height << "), channels("
-            << channels << ")\n";
-
-  glGenTextures(1, &result.texture_id);
-  GLError();
-
-  glBindTexture(GL_TEXTURE_2D, result.texture_id);
-  GLError();
-
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, result.width, result.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-               image);
-  GLError();
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  GLError();
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  GLError();
-
-  glBindTexture(GL_TEXTURE_2D, 0);
-
-  stbi_image_free(image);
-
-  return result;
-}
-
-GLuint CreateShader(GLenum type, const char* source) {
-  GLuint id = glCreateShader(type);
-  GLError();
-
-  const GLchar* s = source;
-  auto length = static_cast<GLint>(std::strlen(source));
-  glShaderSource(id, 1, &s, &length);
-  GLError();
-
-  return id;
+void print_usage() {
+  std::cerr << "Usage: core-graphics [--headless] [--frames N] [--output DIR] [--raw] "
+               "[--size WIDTHxHEIGHT] [--trace FILE] [--compress bc1|bc3|bc7] [--atlas] "
+               "[--fps-cap N] [--swap-interval N] [--frames-in-flight N] [--late-input] "
+               "[--frame-times FILE]\n";
 }
 
-GLuint CreateProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
-  GLuint vertexShaderId = CreateShader(GL_VERTEX_SHADER, vertexShaderSource);
-  GLuint fragmentShaderId = CreateShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-  // Create and compile the program.
-  GLuint programId = glCreateProgram();
-  GLError();
-
-  glAttachShader(programId, vertexShaderId);
-  GLError();
-
-  glAttachShader(programId, fragmentShaderId);
-  GLError();
-
-  glLinkProgram(programId);
-  GLError();
-
-  // Print out some information about the program.
-  std::string buffer(1024, 0);
-  GLsizei outLength = 0;
-  glGetProgramInfoLog(programId, static_cast<GLsizei>(buffer.size()), &outLength,
-                      (GLchar*)buffer.data());
-  buffer.resize(outLength);
-  if (!buffer.empty()) {
-    std::cerr << "Error in shader:\n" << buffer;
+bool parse_options(int argc, char* argv[], Options* options) {
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+    if (std::strcmp(arg, "--headless") == 0) {
+      options->headless = true;
+    } else if (std::strcmp(arg, "--raw") == 0) {
+      options->raw = true;
+    } else if (std::strcmp(arg, "--atlas") == 0) {
+      options->atlas = true;
+    } else if (std::strcmp(arg, "--late-input") == 0) {
+      options->late_input = true;
+    } else if (std::strcmp(arg, "--fps-cap") == 0 && value) {
+      options->fps_cap = std::atof(value);
+      ++i;
+    } else if (std::strcmp(arg, "--swap-interval") == 0 && value) {
+      options->swap_interval = std::atoi(value);
+      ++i;
+    } else if (std::strcmp(arg, "--frames-in-flight") == 0 && value) {
+      options->frames_in_flight = std::max<size_t>(std::strtoul(value, nullptr, 10), 1);
+      ++i;
+    } else if (std::strcmp(arg, "--frame-times") == 0 && value) {
+      options->frame_times_path = value;
+      ++i;
+    } else if (std::strcmp(arg, "--frames") == 0 && value) {
+      options->frames = std::strtoul(value, nullptr, 10);
+      ++i;
+    } else if (std::strcmp(arg, "--output") == 0 && value) {
+      options->output_dir = value;
+      ++i;
+    } else if (std::strcmp(arg, "--trace") == 0 && value) {
+      options->trace_path = value;
+      ++i;
+    } else if (std::strcmp(arg, "--compress") == 0 && value) {
+      if (!parse_block_format(value, &options->texture_format)) {
+        std::cerr << "Unknown texture format " << value << ".\n";
+        return false;
+      }
+      options->compress = true;
+      ++i;
+    } else if (std::strcmp(arg, "--size") == 0 && value) {
+      if (std::sscanf(value, "%dx%d", &options->width, &options->height) != 2 ||
+          options->width <= 0 || options->height <= 0) {
+        std::cerr << "Invalid size " << value << ".\n";
+        return false;
+      }
+      ++i;
+    } else {
+      std::cerr << "Unknown argument " << arg << ".\n";
+      return false;
+    }
   }
 
-  return programId;
-}
-
-void render_mesh(GLuint program, GLuint mode, GLuint mesh, size_t count, GLuint texture) {
-  glUseProgram(program);
-  GLError();
-
-  glBindVertexArray(mesh);
-  GLError();
-
-  if (texture) {
-    glBindTexture(GL_TEXTURE_2D, texture);
-    // glActiveTexture(GL_TEXTURE0 + 0);
-    GLError();
+  if (options->headless && options->frames == 0) {
+    options->frames = kDefaultHeadlessFrames;
   }
 
-  auto location = glGetUniformLocation(program, "u_texture");
-  glUniform1i(location, 0);
-  GLError();
-
-  glDrawArrays(mode, 0, (GLsizei)count);
-  GLError();
-}
-
-void render_mesh(GLuint program, GLuint mode, const Mesh& mesh, Texture* texture) {
-  render_mesh(program, mode, mesh.vertex_array_object, mesh.vertex_count,
-              texture ? texture->texture_id : 0);
+  return true;
 }
 
 void window_size_changed(GLFWwindow* window, int width, int height) {
@@ -237,31 +157,50 @@ void window_size_changed(GLFWwindow* window, int width, int height) {
 
 #if defined(WIN32)
 int WINAPI WinMain(HINSTANCE, HINSTANCE, PSTR, int) {
+  int argc = __argc;
+  char** argv = __argv;
 #else
 int main(int argc, char* argv[]) {
 #endif
-  if (glfwInit() != GLFW_TRUE) {
+  Options options;
+  if (!parse_options(argc, argv, &options)) {
+    print_usage();
     return 1;
   }
 
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-  glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_FALSE);
-  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  GLFWwindow* window = nullptr;
+  HeadlessContext headless_context;
+  if (options.headless) {
+    if (!headless_context.init(4, 3)) {
+      return 1;
+    }
+  } else {
+    if (glfwInit() != GLFW_TRUE) {
+      return 1;
+    }
 
-  GLFWwindow* window =
-      glfwCreateWindow(DISPLAY_WIDTH, DISPLAY_HEIGHT, "Core Graphics", nullptr, nullptr);
-  if (!window) {
-    return 1;
-  }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_FALSE);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if !defined(NDEBUG)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
 
-  glfwSetWindowSizeCallback(window, window_size_changed);
+    window = glfwCreateWindow(options.width, options.height, "Core Graphics", nullptr, nullptr);
+    if (!window) {
+      return 1;
+    }
 
-  glfwMakeContextCurrent(window);
+    glfwSetWindowSizeCallback(window, window_size_changed);
 
-  // glewExperimental = GL_TRUE;
-  GLenum err = glewInit();
-  if (err != GLEW_OK) {
+    glfwMakeContextCurrent(window);
+    if (options.swap_interval >= 0) {
+      glfwSwapInterval(options.swap_interval);
+    }
+  }
+
+  if (!init_glew(options.headless)) {
     std::cerr << "Could not initialize GLEW.\n";
     return 1;
   }
@@ -270,71 +209,287 @@ int main(int argc, char* argv[]) {
   std::cout << "GLEW: " << glewGetString(GLEW_VERSION) << '\n';
 
   GLError();
+  if (!enable_debug_output()) {
+    std::cout << "Debug output is not available, falling back to glGetError.\n";
+  }
 
   // Create the program we're going to use for rendering.
-  GLuint programId = CreateProgram(kVertexShader, kFragmentShader);
-  if (!programId) {
+  ShaderCache shader_cache{CORE_GRAPHICS_SHADER_CACHE_DIR};
+  ShaderProgram* program =
+      shader_cache.load(CORE_GRAPHICS_RESOURCES_DIR "/shaders/default.vert",
+                        CORE_GRAPHICS_RESOURCES_DIR "/shaders/default.frag");
+  if (!program) {
     std::cerr << "Could not create program.\n";
     return 1;
   }
-
-  glUseProgram(programId);
-  GLError();
+  shader_cache.print_stats();
 
   // Set up the geometry.
   constexpr float size = 0.5;
 
-  Vertex vertices[] = {
-      {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
-      {{size, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
-      {{size, size, 0.0f}, {0.0f, 0.0f, 1.0f, 1.0f}, {1.0f, 1.0f}},
-      {{0.0f, size, 0.0f}, {1.0f, 1.0f, 0.0f, 1.0f}, {0.0f, 1.0f}},
-  };
+  AssetLoader asset_loader;
+  if (!asset_loader.init()) {
+    std::cerr << "Could not create asset loader.\n";
+    return 1;
+  }
 
-  auto mesh = create_mesh(vertices, sizeof(vertices) / sizeof(Vertex));
+  // With --compress the texture is block compressed while loading, and with --atlas it is packed
+  // into an atlas page.  Otherwise prefer the cooked asset pack.  Either way, fall back to decoding
+  // the source image in the background.
+  AssetPack asset_pack;
+  TextureAtlas atlas;
+  Texture texture{};
+  glm::vec4 sprite_uv_rect{0.0f, 0.0f, 1.0f, 1.0f};
+  TextureFuture texture_future;
+  if (options.compress) {
+    texture = load_texture(CORE_GRAPHICS_RESOURCES_DIR "/block_test.png", options.texture_format,
+                           true);
+  } else if (options.atlas) {
+    AtlasOptions atlas_options;
+    atlas_options.page_width = 256;
+    atlas_options.page_height = 256;
+    atlas_options.mip_levels = 4;
+    std::vector<AtlasHandle> handles;
+    if (load_texture({CORE_GRAPHICS_RESOURCES_DIR "/block_test.png"}, atlas_options, &atlas,
+                     &handles) &&
+        handles[0].texture) {
+      texture.texture_id = handles[0].texture;
+      sprite_uv_rect = handles[0].uv_rect;
+    }
+  } else if (asset_pack.open(CORE_GRAPHICS_ASSET_PACK)) {
+    texture = load_texture(asset_pack, "block_test.png");
+  }
+  if (!texture.texture_id) {
+    texture_future = asset_loader.load_texture(CORE_GRAPHICS_RESOURCES_DIR "/block_test.png");
+  }
 
-  // auto texture = load_texture("/home/tilo/code/core-graphics/resources/block_test.png");
-  auto texture = load_texture(R"(C:\Code\core-graphics\resources\block_test.png)");
-  glBindTexture(GL_TEXTURE_2D, texture.texture_id);
-  GLError();
+  BatchRenderer batch_renderer;
+  if (!batch_renderer.init(16384)) {
+    std::cerr << "Could not create batch renderer.\n";
+    return 1;
+  }
 
-  GLint projection_matrix_location = glGetUniformLocation(programId, "u_projection_matrix");
-  GLError();
-  GLint view_matrix_location = glGetUniformLocation(programId, "u_view_matrix");
-  GLError();
-  GLint model_matrix_location = glGetUniformLocation(programId, "u_model_matrix");
+  // Headless frames go to an offscreen framebuffer and are read back asynchronously.
+  RenderTarget render_target;
+  FrameReadback readback;
+  if (options.headless) {
+    if (!render_target.init(options.width, options.height) ||
+        !readback.init(options.width, options.height)) {
+      std::cerr << "Could not create the offscreen render target.\n";
+      return 1;
+    }
+    render_target.bind();
+
+    if (!options.output_dir.empty()) {
+      std::error_code error;
+      std::filesystem::create_directories(options.output_dir, error);
+    }
+
+    // Every frame should look the same, so wait for the texture instead of streaming it in.
+    while (!asset_loader.idle()) {
+      asset_loader.process_uploads();
+      std::this_thread::yield();
+    }
+  }
 
   // glm::mat4 projection{1.0f};
-  glm::mat4 projection = glm::perspective(60.0f, (float)DISPLAY_WIDTH / (float)DISPLAY_HEIGHT, 0.01f, 100.0f);
+  glm::mat4 projection =
+      glm::perspective(60.0f, (float)options.width / (float)options.height, 0.01f, 100.0f);
   glm::mat4 view{1.0f};
   view = glm::lookAt(glm::vec3{0.0f, 0.0f, -0.5f}, {0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f});
   glm::mat4 model{1.0f};
 
-  glUniformMatrix4fv(projection_matrix_location, 1, GL_FALSE, glm::value_ptr(projection));
-  GLError();
-  glUniformMatrix4fv(view_matrix_location, 1, GL_FALSE, glm::value_ptr(view));
-  GLError();
-  glUniformMatrix4fv(model_matrix_location, 1, GL_FALSE, glm::value_ptr(model));
-  GLError();
+  // Uniforms only change when the program is rebuilt by a hot reload, so set them once per
+  // program generation instead of on every draw.
+  auto set_uniforms = [&]() {
+    const ShaderReflection& reflection = program->reflection;
+    glUseProgram(program->id);
+    glUniform1i(reflection.uniform_location("u_texture"), 0);
+    glUniformMatrix4fv(reflection.uniform_location("u_projection_matrix"), 1, GL_FALSE,
+                       glm::value_ptr(projection));
+    glUniformMatrix4fv(reflection.uniform_location("u_view_matrix"), 1, GL_FALSE,
+                       glm::value_ptr(view));
+    glUniformMatrix4fv(reflection.uniform_location("u_model_matrix"), 1, GL_FALSE,
+                       glm::value_ptr(model));
+    GLError();
+  };
+  set_uniforms();
+
+  Image frame_image;
+  size_t frames_written = 0;
+  double write_ms = 0.0;
+  auto write_frame = [&](uint64_t frame) {
+    if (options.output_dir.empty()) {
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05llu.%s", static_cast<unsigned long long>(frame),
+                  options.raw ? "rgba" : "png");
+    std::string path = options.output_dir + "/" + name;
+    if (options.raw ? write_raw(path, frame_image) : write_png(path, frame_image)) {
+      ++frames_written;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    write_ms += elapsed.count();
+  };
+
+  FrameSchedulerConfig scheduler_config;
+  scheduler_config.simulation_hz = kSimulationHz;
+  scheduler_config.max_fps = options.fps_cap;
+  scheduler_config.max_frames_in_flight = options.frames_in_flight;
+  // Headless frames are compared against golden images, so they advance one step per frame.
+  if (options.headless) {
+    scheduler_config.fixed_frame_seconds = 1.0 / kSimulationHz;
+  }
+  FrameScheduler scheduler{scheduler_config};
+
+  // The sprite orbits the origin in fixed simulation steps and is offset by the cursor.
+  constexpr float kOrbitRadius = 0.1f;
+  double simulation_time = 0.0;
+  glm::vec2 previous_position{kOrbitRadius, 0.0f};
+  glm::vec2 current_position = previous_position;
+  glm::vec2 cursor{0.0f};
+
+  auto sample_input = [&]() {
+    if (!window) {
+      return;
+    }
 
-  while (!glfwWindowShouldClose(window)) {
     glfwPollEvents();
+    int width = 0;
+    int height = 0;
+    double x = 0.0;
+    double y = 0.0;
+    glfwGetWindowSize(window, &width, &height);
+    glfwGetCursorPos(window, &x, &y);
+    if (width > 0 && height > 0) {
+      cursor = {float(x / width) * 2.0f - 1.0f, 1.0f - float(y / height) * 2.0f};
+    }
+  };
+
+  auto start_time = std::chrono::steady_clock::now();
+  for (uint64_t frame = 0;; ++frame) {
+    if (options.frames && frame == options.frames) {
+      break;
+    }
+
+    PROFILE_BEGIN_FRAME();
+
+    scheduler.begin_frame();
+
+    if (window && glfwWindowShouldClose(window)) {
+      break;
+    }
+    sample_input();
+
+    for (int step = 0; step < scheduler.steps(); ++step) {
+      simulation_time += scheduler.step_seconds();
+      previous_position = current_position;
+      current_position = kOrbitRadius * glm::vec2{std::cos(simulation_time),
+                                                  std::sin(simulation_time)};
+    }
+
+    if (shader_cache.reload_changed()) {
+      set_uniforms();
+    }
 
     glClearColor(0.2f, 0.3f, 0.4f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     GLError();
 
-    render_mesh(programId, GL_TRIANGLE_FAN, mesh, &texture);
+    asset_loader.process_uploads();
+
+    if (!texture.texture_id && texture_future.is_resident()) {
+      texture = texture_future.texture();
+    }
+
+    // Input that arrives while the frame was being prepared still makes it into this frame.
+    if (options.late_input) {
+      sample_input();
+    }
+
+    if (texture.texture_id) {
+      glm::vec2 position = glm::mix(previous_position, current_position,
+                                    float(scheduler.alpha())) + cursor * 0.25f;
+      Quad sprite{};
+      sprite.position = glm::vec3{position, 0.0f};
+      sprite.size = {size, size};
+      sprite.uv_rect = sprite_uv_rect;
+      batch_renderer.submit(program->id, texture.texture_id, sprite);
+    }
+    batch_renderer.flush();
+
+    if (window) {
+      glfwSwapBuffers(window);
+    } else {
+      PROFILE_ZONE("readback");
+      // Collect the previous frame while this one renders.
+      uint64_t finished_frame = 0;
+      if (readback.pending() == FrameReadback::kBufferCount &&
+          readback.collect(true, &frame_image, &finished_frame)) {
+        write_frame(finished_frame);
+      }
+      readback.read(frame);
+    }
+
+    scheduler.end_frame();
+
+    PROFILE_END_FRAME();
+  }
+
+  if (options.headless) {
+    uint64_t finished_frame = 0;
+    while (readback.collect(true, &frame_image, &finished_frame)) {
+      write_frame(finished_frame);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    std::cout << "Rendered " << options.frames << " frames at " << options.width << "x"
+              << options.height << " in " << elapsed.count() * 1000.0 << " ms ("
+              << double(options.frames) / elapsed.count() << " frames/s).\n";
+    if (frames_written) {
+      std::cout << "Wrote " << frames_written << " frames to " << options.output_dir << " in "
+                << write_ms << " ms.\n";
+    }
+  }
+
+  std::cout << "Frame times: ";
+  scheduler.frame_times().print_summary(std::cout);
+  std::cout << "Waited " << scheduler.fence_wait_ms() << " ms for the GPU and "
+            << scheduler.cap_wait_ms() << " ms for the frame cap.\n";
+  if (!options.frame_times_path.empty() &&
+      scheduler.frame_times().write_csv(options.frame_times_path)) {
+    std::cout << "Wrote frame times to " << options.frame_times_path << ".\n";
+  }
 
-    glfwSwapBuffers(window);
+#if defined(CORE_GRAPHICS_PROFILING)
+  if (!options.trace_path.empty() && Profiler::instance().write_chrome_trace(options.trace_path)) {
+    std::cout << "Wrote trace to " << options.trace_path << ".\n";
   }
+  Profiler::instance().destroy();
+#else
+  if (!options.trace_path.empty()) {
+    std::cerr << "Built without CORE_GRAPHICS_PROFILING, no trace written.\n";
+  }
+#endif
+
+  scheduler.destroy();
+  readback.destroy();
+  render_target.destroy();
+  batch_renderer.destroy();
+  atlas.destroy();
+  asset_loader.destroy();
 
   // Delete the program.
-  glDeleteProgram(programId);
+  shader_cache.destroy();
 
-  glfwDestroyWindow(window);
+  if (window) {
+    glfwDestroyWindow(window);
 
-  glfwTerminate();
+    glfwTerminate();
+  }
 
   return 0;
 }
@@ -0,0 +1,114 @@
+#include "mesh.h"
+
+#include <utility>
+
+#include "gl_error.h"
+#include "profiler.h"
+
+void set_vertex_attributes() {
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), nullptr);
+
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(float) * 3));
+
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(sizeof(float) * 7));
+}
+
+Mesh::Mesh(Mesh&& other) noexcept {
+  *this = std::move(other);
+}
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept {
+  std::swap(vertex_array_object, other.vertex_array_object);
+  std::swap(vertex_buffer, other.vertex_buffer);
+  std::swap(index_buffer, other.index_buffer);
+  std::swap(vertex_count, other.vertex_count);
+  std::swap(index_count, other.index_count);
+  return *this;
+}
+
+Mesh::~Mesh() {
+  if (vertex_array_object) {
+    glDeleteVertexArrays(1, &vertex_array_object);
+  }
+  if (vertex_buffer) {
+    glDeleteBuffers(1, &vertex_buffer);
+  }
+  if (index_buffer) {
+    glDeleteBuffers(1, &index_buffer);
+  }
+}
+
+Mesh create_mesh(const Vertex* vertices, size_t count, const uint32_t* indices,
+                 size_t index_count) {
+  Mesh mesh;
+  mesh.vertex_count = (GLsizei)count;
+  mesh.index_count = (GLsizei)index_count;
+
+  glGenVertexArrays(1, &mesh.vertex_array_object);
+  glBindVertexArray(mesh.vertex_array_object);
+
+  // Create the vertex buffer.
+  glGenBuffers(1, &mesh.vertex_buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.vertex_buffer);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(count * sizeof(Vertex)), vertices, GL_STATIC_DRAW);
+  PROFILE_COUNT(kBufferUploads, indices ? 2 : 1);
+  PROFILE_COUNT(kUploadBytes, count * sizeof(Vertex) + index_count * sizeof(uint32_t));
+
+  set_vertex_attributes();
+
+  if (indices) {
+    glGenBuffers(1, &mesh.index_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(index_count * sizeof(uint32_t)), indices,
+                 GL_STATIC_DRAW);
+  }
+  GLError();
+
+  glBindVertexArray(0);
+
+  return mesh;
+}
+
+void render_mesh(GLuint program, GLuint mode, GLuint mesh, size_t count, GLuint texture) {
+  PROFILE_COUNT(kStateChanges, texture ? 3 : 2);
+  PROFILE_COUNT(kDrawCalls, 1);
+
+  glUseProgram(program);
+  GLError();
+
+  glBindVertexArray(mesh);
+  GLError();
+
+  if (texture) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    // glActiveTexture(GL_TEXTURE0 + 0);
+    GLError();
+  }
+
+  glDrawArrays(mode, 0, (GLsizei)count);
+  GLError();
+}
+
+void render_mesh(GLuint program, GLuint mode, const Mesh& mesh, Texture* texture) {
+  if (!mesh.index_buffer) {
+    render_mesh(program, mode, mesh.vertex_array_object, mesh.vertex_count,
+                texture ? texture->texture_id : 0);
+    return;
+  }
+
+  PROFILE_COUNT(kStateChanges, texture ? 3 : 2);
+  PROFILE_COUNT(kDrawCalls, 1);
+
+  glUseProgram(program);
+  glBindVertexArray(mesh.vertex_array_object);
+  if (texture) {
+    glBindTexture(GL_TEXTURE_2D, texture->texture_id);
+  }
+  GLError();
+
+  glDrawElements(mode, mesh.index_count, GL_UNSIGNED_INT, nullptr);
+  GLError();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "texture.h"
+#include "vertex.h"
+
+// Enables attributes 0-2 for `Vertex` on the currently bound vertex array, reading from the
+// currently bound GL_ARRAY_BUFFER.
+void set_vertex_attributes();
+
+// A mesh with its own vertex array and buffers.  Meshes own their GL objects, so they can only be
+// moved.
+struct Mesh {
+  GLuint vertex_array_object = 0;
+  GLuint vertex_buffer = 0;
+  GLuint index_buffer = 0;
+  GLsizei vertex_count = 0;
+  GLsizei index_count = 0;
+
+  Mesh() = default;
+  Mesh(Mesh&& other) noexcept;
+  Mesh& operator=(Mesh&& other) noexcept;
+  ~Mesh();
+
+  Mesh(const Mesh&) = delete;
+  Mesh& operator=(const Mesh&) = delete;
+};
+
+// `indices` is optional; without it the mesh is drawn with glDrawArrays.
+Mesh create_mesh(const Vertex* vertices, size_t count, const uint32_t* indices = nullptr,
+                 size_t index_count = 0);
+
+void render_mesh(GLuint program, GLuint mode, GLuint mesh, size_t count, GLuint texture);
+void render_mesh(GLuint program, GLuint mode, const Mesh& mesh, Texture* texture);
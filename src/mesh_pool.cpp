@@ -0,0 +1,71 @@
+#include "mesh_pool.h"
+
+#include "gl_error.h"
+#include "profiler.h"
+
+MeshPool::~MeshPool() {
+  destroy();
+}
+
+bool MeshPool::init(size_t max_vertices, size_t max_indices) {
+  max_vertices_ = max_vertices;
+  max_indices_ = max_indices;
+
+  glGenBuffers(1, &vertex_buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(max_vertices * sizeof(Vertex)), nullptr,
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Bind to GL_COPY_WRITE_BUFFER so we do not disturb the element binding of whatever vertex array
+  // happens to be bound.
+  glGenBuffers(1, &index_buffer_);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer_);
+  glBufferData(GL_COPY_WRITE_BUFFER, GLsizeiptr(max_indices * sizeof(uint32_t)), nullptr,
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  GLError();
+
+  return true;
+}
+
+void MeshPool::destroy() {
+  if (vertex_buffer_) {
+    glDeleteBuffers(1, &vertex_buffer_);
+    vertex_buffer_ = 0;
+  }
+  if (index_buffer_) {
+    glDeleteBuffers(1, &index_buffer_);
+    index_buffer_ = 0;
+  }
+  vertex_count_ = 0;
+  index_count_ = 0;
+}
+
+bool MeshPool::add(const Vertex* vertices, size_t vertex_count, const uint32_t* indices,
+                   size_t index_count, MeshHandle* handle) {
+  if (vertex_count_ + vertex_count > max_vertices_ || index_count_ + index_count > max_indices_) {
+    return false;
+  }
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer_);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(vertex_count_ * sizeof(Vertex)),
+                  GLsizeiptr(vertex_count * sizeof(Vertex)), vertices);
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer_);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(index_count_ * sizeof(uint32_t)),
+                  GLsizeiptr(index_count * sizeof(uint32_t)), indices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  GLError();
+  PROFILE_COUNT(kBufferUploads, 2);
+  PROFILE_COUNT(kUploadBytes, vertex_count * sizeof(Vertex) + index_count * sizeof(uint32_t));
+
+  handle->index_count = uint32_t(index_count);
+  handle->first_index = uint32_t(index_count_);
+  handle->base_vertex = int32_t(vertex_count_);
+
+  vertex_count_ += vertex_count;
+  index_count_ += index_count;
+
+  return true;
+}
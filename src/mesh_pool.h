@@ -0,0 +1,50 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vertex.h"
+
+// Location of a mesh inside a `MeshPool`.  Matches the per-draw fields of an indirect draw.
+struct MeshHandle {
+  uint32_t index_count = 0;
+  uint32_t first_index = 0;
+  int32_t base_vertex = 0;
+};
+
+// Sub-allocates static geometry from one shared vertex buffer and one shared index buffer, so any
+// number of meshes can be drawn without switching buffers.  Allocations are never freed
+// individually; the whole pool is destroyed at once.
+class MeshPool {
+public:
+  MeshPool() = default;
+  ~MeshPool();
+
+  MeshPool(const MeshPool&) = delete;
+  MeshPool& operator=(const MeshPool&) = delete;
+
+  bool init(size_t max_vertices, size_t max_indices);
+  void destroy();
+
+  // Indices are relative to the first vertex of this mesh.  Returns false if the pool is full.
+  bool add(const Vertex* vertices, size_t vertex_count, const uint32_t* indices,
+           size_t index_count, MeshHandle* handle);
+
+  GLuint vertex_buffer() const {
+    return vertex_buffer_;
+  }
+
+  GLuint index_buffer() const {
+    return index_buffer_;
+  }
+
+private:
+  GLuint vertex_buffer_ = 0;
+  GLuint index_buffer_ = 0;
+  size_t max_vertices_ = 0;
+  size_t max_indices_ = 0;
+  size_t vertex_count_ = 0;
+  size_t index_count_ = 0;
+};
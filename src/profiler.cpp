@@ -0,0 +1,199 @@
+#include "profiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Trace track for GPU zones; CPU threads are numbered from 1.
+constexpr uint32_t kGpuThread = 0;
+
+const char* const kCounterNames[kProfileCounterCount] = {
+    "draw_calls", "state_changes", "buffer_uploads", "texture_uploads", "upload_bytes",
+};
+
+struct OpenZone {
+  const char* name;
+  double start_us;
+};
+
+thread_local std::vector<OpenZone> open_zones;
+
+uint32_t current_thread() {
+  static std::atomic<uint32_t> next_thread{1};
+  thread_local uint32_t thread = next_thread.fetch_add(1);
+  return thread;
+}
+
+void write_json_string(std::ostream& out, const char* text) {
+  out << '"';
+  for (const char* c = text; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      out << '\\';
+    }
+    out << *c;
+  }
+  out << '"';
+}
+
+}  // namespace
+
+Profiler& Profiler::instance() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : epoch_{std::chrono::steady_clock::now()} {}
+
+double Profiler::now_us() const {
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - epoch_;
+  return elapsed.count();
+}
+
+void Profiler::add_event(const Event& event) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  if (events_.size() < kMaxEvents) {
+    events_.push_back(event);
+  } else {
+    ++events_dropped_;
+  }
+}
+
+void Profiler::begin_frame() {
+  frame_start_us_ = now_us();
+}
+
+void Profiler::end_frame() {
+  double end_us = now_us();
+  add_event({"frame", frame_start_us_, end_us - frame_start_us_, current_thread()});
+
+  ProfileFrameStats stats;
+  stats.frame = frame_;
+  stats.cpu_ms = (end_us - frame_start_us_) / 1000.0;
+
+  // Resolve the oldest frame in the ring; its slot is reused by the next frame.
+  gpu_frame_ = (gpu_frame_ + 1) % kGpuFrameLatency;
+  GpuFrame& due = gpu_frames_[gpu_frame_];
+  for (size_t i = 0; i < due.used; ++i) {
+    const GpuZone& zone = due.zones[i];
+
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(zone.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+      ++stats.gpu_zones_dropped;
+      continue;
+    }
+
+    GLuint64 elapsed_ns = 0;
+    glGetQueryObjectui64v(zone.query, GL_QUERY_RESULT, &elapsed_ns);
+    add_event({zone.name, zone.start_us, double(elapsed_ns) / 1000.0, kGpuThread});
+    stats.gpu_ms += double(elapsed_ns) / 1e6;
+  }
+  due.used = 0;
+
+  CounterSample sample;
+  sample.time_us = frame_start_us_;
+  for (size_t i = 0; i < kProfileCounterCount; ++i) {
+    sample.values[i] = counters_[i].exchange(0, std::memory_order_relaxed);
+    stats.counters[i] = sample.values[i];
+  }
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (counter_samples_.size() < kMaxEvents) {
+      counter_samples_.push_back(sample);
+    }
+  }
+
+  last_frame_ = stats;
+  ++frame_;
+}
+
+void Profiler::begin_zone(const char* name) {
+  open_zones.push_back({name, now_us()});
+}
+
+void Profiler::end_zone() {
+  if (open_zones.empty()) {
+    return;
+  }
+
+  OpenZone zone = open_zones.back();
+  open_zones.pop_back();
+  add_event({zone.name, zone.start_us, now_us() - zone.start_us, current_thread()});
+}
+
+void Profiler::begin_gpu_zone(const char* name) {
+  if (gpu_depth_++ > 0) {
+    return;
+  }
+
+  GpuFrame& frame = gpu_frames_[gpu_frame_];
+  if (frame.used == frame.zones.size()) {
+    GpuZone zone{};
+    glGenQueries(1, &zone.query);
+    frame.zones.push_back(zone);
+  }
+
+  GpuZone& zone = frame.zones[frame.used++];
+  zone.name = name;
+  zone.start_us = now_us();
+  glBeginQuery(GL_TIME_ELAPSED, zone.query);
+}
+
+void Profiler::end_gpu_zone() {
+  if (--gpu_depth_ > 0) {
+    return;
+  }
+
+  glEndQuery(GL_TIME_ELAPSED);
+}
+
+bool Profiler::write_chrome_trace(std::string_view path) {
+  std::string p{path};
+  std::ofstream out{p};
+  if (!out) {
+    std::cerr << "Could not write trace " << p << ".\n";
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock{mutex_};
+
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << kGpuThread
+      << ",\"args\":{\"name\":\"GPU\"}}";
+
+  for (const auto& event : events_) {
+    out << ",\n{\"name\":";
+    write_json_string(out, event.name);
+    out << ",\"cat\":\"" << (event.thread == kGpuThread ? "gpu" : "cpu")
+        << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread << ",\"ts\":" << event.start_us
+        << ",\"dur\":" << event.duration_us << '}';
+  }
+
+  for (const auto& sample : counter_samples_) {
+    for (size_t i = 0; i < kProfileCounterCount; ++i) {
+      out << ",\n{\"name\":\"" << kCounterNames[i] << "\",\"ph\":\"C\",\"pid\":1,\"ts\":"
+          << sample.time_us << ",\"args\":{\"value\":" << sample.values[i] << "}}";
+    }
+  }
+
+  out << "\n]}\n";
+
+  if (events_dropped_) {
+    std::cerr << "Trace is missing " << events_dropped_ << " zones over the limit of "
+              << kMaxEvents << ".\n";
+  }
+
+  return bool(out);
+}
+
+void Profiler::destroy() {
+  for (auto& frame : gpu_frames_) {
+    for (const auto& zone : frame.zones) {
+      glDeleteQueries(1, &zone.query);
+    }
+    frame.zones.clear();
+    frame.used = 0;
+  }
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// CPU/GPU profiling.  Code is instrumented with the PROFILE_* macros at the bottom of this file,
+// which expand to nothing unless CORE_GRAPHICS_PROFILING is defined.
+
+enum class ProfileCounter {
+  kDrawCalls,
+  // Program, vertex array and texture binds.
+  kStateChanges,
+  kBufferUploads,
+  kTextureUploads,
+  kUploadBytes,
+  kCount,
+};
+
+constexpr size_t kProfileCounterCount = size_t(ProfileCounter::kCount);
+
+struct ProfileFrameStats {
+  uint64_t frame = 0;
+  double cpu_ms = 0.0;
+  // Sum of the GPU zones resolved at the end of this frame.  They were issued
+  // `kGpuFrameLatency - 1` frames earlier, since `end_frame` resolves the slot the next frame is
+  // about to reuse.
+  double gpu_ms = 0.0;
+  // GPU zones whose result was still not available when they were due, and were dropped rather
+  // than waited for.
+  size_t gpu_zones_dropped = 0;
+  uint64_t counters[kProfileCounterCount] = {};
+};
+
+// Collects CPU zones, GPU zones and counters for every frame and exports them as a Chrome trace
+// (chrome://tracing or https://ui.perfetto.dev).
+//
+// CPU zones can nest and be recorded from any thread.  GPU zones use GL_TIME_ELAPSED queries from
+// a ring of `kGpuFrameLatency` frames, so results are read back several frames later without ever
+// waiting on the GPU.  Time elapsed queries cannot nest, so a GPU zone opened inside another one is
+// ignored.  GPU zones appear in the trace on their own track, starting at the CPU time they were
+// issued.
+class Profiler {
+public:
+  static constexpr size_t kGpuFrameLatency = 4;
+  // Upper bound on recorded zones, so a long session does not grow without limit.
+  static constexpr size_t kMaxEvents = 1 << 20;
+
+  static Profiler& instance();
+
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  void begin_frame();
+  // Resolves GPU zones that are due and closes the frame's counters.  Call on the GL thread.
+  void end_frame();
+
+  // `name` must outlive the profiler, e.g. a string literal.
+  void begin_zone(const char* name);
+  void end_zone();
+
+  void begin_gpu_zone(const char* name);
+  void end_gpu_zone();
+
+  void count(ProfileCounter counter, uint64_t amount) {
+    counters_[size_t(counter)].fetch_add(amount, std::memory_order_relaxed);
+  }
+
+  const ProfileFrameStats& last_frame() const {
+    return last_frame_;
+  }
+
+  bool write_chrome_trace(std::string_view path);
+
+  // Deletes the GL queries.  Requires the context that created them to be current.
+  void destroy();
+
+private:
+  struct Event {
+    const char* name;
+    double start_us;
+    double duration_us;
+    uint32_t thread;
+  };
+
+  struct CounterSample {
+    double time_us;
+    uint64_t values[kProfileCounterCount];
+  };
+
+  struct GpuZone {
+    const char* name;
+    GLuint query;
+    double start_us;
+  };
+
+  struct GpuFrame {
+    std::vector<GpuZone> zones;
+    size_t used = 0;
+  };
+
+  Profiler();
+
+  double now_us() const;
+  void add_event(const Event& event);
+
+  std::chrono::steady_clock::time_point epoch_;
+
+  std::mutex mutex_;
+  std::vector<Event> events_;
+  std::vector<CounterSample> counter_samples_;
+  size_t events_dropped_ = 0;
+
+  std::atomic<uint64_t> counters_[kProfileCounterCount] = {};
+
+  GpuFrame gpu_frames_[kGpuFrameLatency];
+  size_t gpu_frame_ = 0;
+  int gpu_depth_ = 0;
+
+  uint64_t frame_ = 0;
+  double frame_start_us_ = 0.0;
+  ProfileFrameStats last_frame_;
+};
+
+class ProfileZone {
+public:
+  explicit ProfileZone(const char* name) {
+    Profiler::instance().begin_zone(name);
+  }
+
+  ~ProfileZone() {
+    Profiler::instance().end_zone();
+  }
+
+  ProfileZone(const ProfileZone&) = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+class GpuProfileZone {
+public:
+  explicit GpuProfileZone(const char* name) {
+    Profiler::instance().begin_gpu_zone(name);
+  }
+
+  ~GpuProfileZone() {
+    Profiler::instance().end_gpu_zone();
+  }
+
+  GpuProfileZone(const GpuProfileZone&) = delete;
+  GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+};
+
+#if defined(CORE_GRAPHICS_PROFILING)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__){name}
+#define PROFILE_GPU_ZONE(name) GpuProfileZone PROFILE_CONCAT(gpu_profile_zone_, __LINE__){name}
+#define PROFILE_COUNT(counter, amount) \
+  Profiler::instance().count(ProfileCounter::counter, uint64_t(amount))
+#define PROFILE_BEGIN_FRAME() Profiler::instance().begin_frame()
+#define PROFILE_END_FRAME() Profiler::instance().end_frame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_GPU_ZONE(name) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+#define PROFILE_BEGIN_FRAME() ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,86 @@
+#include "quad_batch.h"
+
+#include <algorithm>
+
+namespace {
+
+uint64_t make_key(uint32_t program, uint32_t texture) {
+  return (uint64_t(program) << 32) | texture;
+}
+
+uint32_t key_program(uint64_t key) {
+  return uint32_t(key >> 32);
+}
+
+uint32_t key_texture(uint64_t key) {
+  return uint32_t(key & 0xffffffff);
+}
+
+}  // namespace
+
+void QuadBatch::clear() {
+  quads_.clear();
+  sorted_.clear();
+}
+
+void QuadBatch::submit(uint32_t program, uint32_t texture, const Quad& quad) {
+  sorted_.push_back({make_key(program, texture), uint32_t(quads_.size())});
+  quads_.push_back(quad);
+}
+
+void QuadBatch::sort() {
+  std::sort(sorted_.begin(), sorted_.end(), [](const SortEntry& a, const SortEntry& b) {
+    return a.key < b.key || (a.key == b.key && a.index < b.index);
+  });
+}
+
+size_t QuadBatch::build(size_t first_quad, size_t max_quads, Vertex* vertices,
+                        std::vector<BatchDrawCommand>* commands) const {
+  if (first_quad >= sorted_.size()) {
+    return 0;
+  }
+
+  size_t count = std::min(max_quads, sorted_.size() - first_quad);
+
+  uint64_t current_key = 0;
+  BatchDrawCommand* command = nullptr;
+
+  for (size_t i = 0; i < count; ++i) {
+    const SortEntry& entry = sorted_[first_quad + i];
+    const Quad& quad = quads_[entry.index];
+
+    if (!command || entry.key != current_key) {
+      current_key = entry.key;
+      commands->push_back({key_program(entry.key), key_texture(entry.key),
+                           uint32_t(i * kIndicesPerQuad), 0});
+      command = &commands->back();
+    }
+    command->index_count += kIndicesPerQuad;
+
+    const glm::vec3& p = quad.position;
+    const glm::vec2& s = quad.size;
+    const glm::vec4& uv = quad.uv_rect;
+
+    Vertex* v = vertices + i * kVerticesPerQuad;
+    v[0] = {{p.x, p.y, p.z}, quad.color, {uv.x, uv.y}};
+    v[1] = {{p.x + s.x, p.y, p.z}, quad.color, {uv.z, uv.y}};
+    v[2] = {{p.x + s.x, p.y + s.y, p.z}, quad.color, {uv.z, uv.w}};
+    v[3] = {{p.x, p.y + s.y, p.z}, quad.color, {uv.x, uv.w}};
+  }
+
+  return count;
+}
+
+// static
+void QuadBatch::generate_indices(uint32_t* indices, size_t quad_count) {
+  for (size_t i = 0; i < quad_count; ++i) {
+    auto base = uint32_t(i * kVerticesPerQuad);
+    uint32_t* out = indices + i * kIndicesPerQuad;
+    out[0] = base + 0;
+    out[1] = base + 1;
+    out[2] = base + 2;
+    out[3] = base + 2;
+    out[4] = base + 3;
+    out[5] = base + 0;
+  }
+}
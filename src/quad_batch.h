@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "vertex.h"
+
+// A single textured, axis aligned quad.  `uv_rect` holds (u0, v0, u1, v1).
+struct Quad {
+  glm::vec3 position;
+  glm::vec2 size;
+  glm::vec4 color{1.0f, 1.0f, 1.0f, 1.0f};
+  glm::vec4 uv_rect{0.0f, 0.0f, 1.0f, 1.0f};
+};
+
+// One indexed draw produced by the batch.  Indices are relative to the first vertex written by the
+// `build` call that produced the command.
+struct BatchDrawCommand {
+  uint32_t program;
+  uint32_t texture;
+  uint32_t first_index;
+  uint32_t index_count;
+};
+
+// CPU side of the batch renderer.  Collects quads for a frame, sorts them by (program, texture) and
+// expands them into vertices plus a list of draw commands.  Quads that share a key keep their
+// submission order.  Does not touch OpenGL, so it can be driven without a context.
+class QuadBatch {
+public:
+  static constexpr uint32_t kVerticesPerQuad = 4;
+  static constexpr uint32_t kIndicesPerQuad = 6;
+
+  void clear();
+
+  void submit(uint32_t program, uint32_t texture, const Quad& quad);
+
+  // Sorts the submitted quads by key.  Must be called before `build`.
+  void sort();
+
+  // Writes up to `max_quads` sorted quads, starting at sorted position `first_quad`, into
+  // `vertices` and appends the draw commands needed to render them.  Returns the number of quads
+  // written.
+  size_t build(size_t first_quad, size_t max_quads, Vertex* vertices,
+               std::vector<BatchDrawCommand>* commands) const;
+
+  size_t quad_count() const {
+    return quads_.size();
+  }
+
+  // Fills `indices` with the fixed (0, 1, 2, 2, 3, 0) pattern for `quad_count` quads.
+  static void generate_indices(uint32_t* indices, size_t quad_count);
+
+private:
+  struct SortEntry {
+    uint64_t key;
+    uint32_t index;
+  };
+
+  std::vector<Quad> quads_;
+  std::vector<SortEntry> sorted_;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Offscreen framebuffer with an RGBA8 color texture and a depth renderbuffer.
+class RenderTarget {
+public:
+  RenderTarget() = default;
+  ~RenderTarget();
+
+  RenderTarget(const RenderTarget&) = delete;
+  RenderTarget& operator=(const RenderTarget&) = delete;
+
+  bool init(int width, int height);
+  void destroy();
+
+  // Binds the framebuffer for drawing and reading and sets the viewport to cover it.
+  void bind() const;
+
+  GLuint framebuffer() const {
+    return framebuffer_;
+  }
+
+  GLuint color_texture() const {
+    return color_texture_;
+  }
+
+  int width() const {
+    return width_;
+  }
+
+  int height() const {
+    return height_;
+  }
+
+private:
+  GLuint framebuffer_ = 0;
+  GLuint color_texture_ = 0;
+  GLuint depth_buffer_ = 0;
+  int width_ = 0;
+  int height_ = 0;
+};
@@ -0,0 +1,416 @@
+#include "shader_cache.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "gl_error.h"
+#include "hash.h"
+#include "shader_source.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint32_t kBinaryMagic = 0x42534743;  // "CGSB"
+
+struct BinaryHeader {
+  uint32_t magic;
+  uint32_t format;
+  uint64_t key;
+  uint64_t length;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// `files` are the files the source was expanded from, main file first.
+GLuint compile_shader(GLenum type, const std::string& source,
+                      const std::vector<std::string>& files) {
+  GLuint id = glCreateShader(type);
+  GLError();
+
+  const GLchar* s = source.c_str();
+  auto length = static_cast<GLint>(source.size());
+  glShaderSource(id, 1, &s, &length);
+  glCompileShader(id);
+  GLError();
+
+  GLint status = GL_FALSE;
+  glGetShaderiv(id, GL_COMPILE_STATUS, &status);
+  if (status != GL_TRUE) {
+    std::string buffer(1024, 0);
+    GLsizei outLength = 0;
+    glGetShaderInfoLog(id, static_cast<GLsizei>(buffer.size()), &outLength,
+                       (GLchar*)buffer.data());
+    buffer.resize(outLength);
+    std::cerr << "Error in shader " << files[0] << ":\n" << buffer;
+    // Messages are prefixed with the source string number set by the `#line` directives.
+    if (files.size() > 1) {
+      for (size_t i = 0; i < files.size(); ++i) {
+        std::cerr << "  source " << i << ": " << files[i] << '\n';
+      }
+    }
+    glDeleteShader(id);
+    return 0;
+  }
+
+  return id;
+}
+
+bool check_link_status(GLuint program, const std::string& name) {
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (status == GL_TRUE) {
+    return true;
+  }
+
+  if (!name.empty()) {
+    std::string buffer(1024, 0);
+    GLsizei outLength = 0;
+    glGetProgramInfoLog(program, static_cast<GLsizei>(buffer.size()), &outLength,
+                        (GLchar*)buffer.data());
+    buffer.resize(outLength);
+    std::cerr << "Error linking " << name << ":\n" << buffer;
+  }
+
+  return false;
+}
+
+std::vector<ShaderReflection::Variable> reflect_variables(GLuint program, GLenum interface) {
+  GLint count = 0;
+  glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+
+  std::vector<ShaderReflection::Variable> result;
+  result.reserve(size_t(count));
+
+  const GLenum properties[] = {GL_NAME_LENGTH, GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE};
+  for (GLint i = 0; i < count; ++i) {
+    GLint values[4] = {};
+    glGetProgramResourceiv(program, interface, GLuint(i), 4, properties, 4, nullptr, values);
+
+    // Members of uniform blocks have no location and are described by their block instead.
+    if (values[2] < 0) {
+      continue;
+    }
+
+    std::string name(size_t(values[0]), '\0');
+    glGetProgramResourceName(program, interface, GLuint(i), values[0], nullptr, name.data());
+    name.resize(name.size() - 1);
+
+    result.push_back({std::move(name), values[2], GLenum(values[1]), values[3]});
+  }
+
+  return result;
+}
+
+std::vector<ShaderReflection::Block> reflect_blocks(GLuint program, GLenum interface) {
+  GLint count = 0;
+  glGetProgramInterfaceiv(program, interface, GL_ACTIVE_RESOURCES, &count);
+
+  std::vector<ShaderReflection::Block> result;
+  result.reserve(size_t(count));
+
+  const GLenum properties[] = {GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+  for (GLint i = 0; i < count; ++i) {
+    GLint values[3] = {};
+    glGetProgramResourceiv(program, interface, GLuint(i), 3, properties, 3, nullptr, values);
+
+    std::string name(size_t(values[0]), '\0');
+    glGetProgramResourceName(program, interface, GLuint(i), values[0], nullptr, name.data());
+    name.resize(name.size() - 1);
+
+    result.push_back({std::move(name), GLuint(i), values[1], values[2]});
+  }
+
+  return result;
+}
+
+}  // namespace
+
+GLint ShaderReflection::uniform_location(std::string_view name) const {
+  auto it = uniform_locations_.find(std::string{name});
+  return it != uniform_locations_.end() ? it->second : -1;
+}
+
+GLint ShaderReflection::attribute_location(std::string_view name) const {
+  for (const auto& attribute : attributes) {
+    if (attribute.name == name) {
+      return attribute.location;
+    }
+  }
+  return -1;
+}
+
+ShaderCache::ShaderCache(std::string cache_dir) : cache_dir_{std::move(cache_dir)} {}
+
+ShaderCache::~ShaderCache() {
+  destroy();
+}
+
+ShaderProgram* ShaderCache::load(const std::string& vertex_path,
+                                 const std::string& fragment_path) {
+  if (driver_id_.empty()) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binaries_supported_ = formats > 0 && !cache_dir_.empty();
+    if (binaries_supported_) {
+      std::error_code ec;
+      fs::create_directories(cache_dir_, ec);
+    }
+
+    // Binaries are only valid for the driver that produced them.
+    driver_id_ = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    driver_id_ += reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  }
+
+  auto program = std::make_unique<ShaderProgram>();
+  program->vertex_path = vertex_path;
+  program->fragment_path = fragment_path;
+
+  if (!build(program.get())) {
+    return nullptr;
+  }
+
+  ++stats_.programs;
+  programs_.push_back(std::move(program));
+
+  return programs_.back().get();
+}
+
+bool ShaderCache::build(ShaderProgram* program) {
+  std::string vertex_source;
+  std::string fragment_source;
+  // Each stage needs its own include-once set, or a file included by both would be left out of
+  // the fragment shader.
+  std::vector<std::string> vertex_files;
+  std::vector<std::string> fragment_files;
+  if (!load_shader_source(program->vertex_path, &vertex_source, &vertex_files) ||
+      !load_shader_source(program->fragment_path, &fragment_source, &fragment_files)) {
+    return false;
+  }
+
+  uint64_t key = fnv1a_64(driver_id_);
+  key = fnv1a_64(vertex_source.data(), vertex_source.size(), key);
+  key = fnv1a_64(fragment_source.data(), fragment_source.size(), key);
+
+  GLuint id = load_binary(key);
+
+  if (id) {
+    ++stats_.binary_hits;
+  } else {
+    ++stats_.binary_misses;
+
+    auto start = Clock::now();
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_source, vertex_files);
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source, fragment_files);
+    stats_.compile_ms += elapsed_ms(start);
+
+    if (vertex_shader && fragment_shader) {
+      start = Clock::now();
+      id = glCreateProgram();
+      if (binaries_supported_) {
+        glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+      }
+      glAttachShader(id, vertex_shader);
+      glAttachShader(id, fragment_shader);
+      glLinkProgram(id);
+      GLError();
+
+      if (!check_link_status(id, program->vertex_path + " + " + program->fragment_path)) {
+        glDeleteProgram(id);
+        id = 0;
+      }
+      stats_.link_ms += elapsed_ms(start);
+    }
+
+    // The program keeps what it needs after linking.
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    if (!id) {
+      return false;
+    }
+
+    store_binary(key, id);
+  }
+
+  if (program->id) {
+    glDeleteProgram(program->id);
+    ++program->generation;
+  }
+  program->id = id;
+
+  program->dependencies.clear();
+  program->dependency_times.clear();
+  for (const auto* files : {&vertex_files, &fragment_files}) {
+    for (const auto& dependency : *files) {
+      if (std::find(program->dependencies.begin(), program->dependencies.end(),
+                    fs::path{dependency}) != program->dependencies.end()) {
+        continue;
+      }
+      std::error_code ec;
+      program->dependencies.emplace_back(dependency);
+      program->dependency_times.push_back(fs::last_write_time(dependency, ec));
+    }
+  }
+
+  reflect(program);
+
+  return true;
+}
+
+GLuint ShaderCache::load_binary(uint64_t key) {
+  if (!binaries_supported_) {
+    return 0;
+  }
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  fs::path path = fs::path{cache_dir_} / name;
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream) {
+    return 0;
+  }
+
+  auto start = Clock::now();
+
+  BinaryHeader header{};
+  stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!stream || header.magic != kBinaryMagic || header.key != key) {
+    return 0;
+  }
+
+  // A corrupt length is a cache miss, not a huge allocation.
+  std::error_code ec;
+  uintmax_t file_size = fs::file_size(path, ec);
+  if (ec || header.length > file_size - sizeof(header) || header.length > uint64_t(INT_MAX)) {
+    return 0;
+  }
+
+  std::vector<char> binary(header.length);
+  stream.read(binary.data(), std::streamsize(binary.size()));
+  if (!stream) {
+    return 0;
+  }
+
+  GLuint id = glCreateProgram();
+  glProgramBinary(id, GLenum(header.format), binary.data(), GLsizei(binary.size()));
+
+  // Drivers reject binaries after updates; that is a normal cache miss.
+  if (!check_link_status(id, {})) {
+    glDeleteProgram(id);
+    return 0;
+  }
+
+  stats_.binary_load_ms += elapsed_ms(start);
+
+  return id;
+}
+
+void ShaderCache::store_binary(uint64_t key, GLuint program) {
+  if (!binaries_supported_) {
+    return;
+  }
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return;
+  }
+
+  std::vector<char> binary(size_t(length), 0);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+  GLError();
+
+  BinaryHeader header{kBinaryMagic, format, key, uint64_t(length)};
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  std::ofstream stream{fs::path{cache_dir_} / name, std::ios::binary | std::ios::trunc};
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(binary.data(), length);
+}
+
+void ShaderCache::reflect(ShaderProgram* program) {
+  ShaderReflection& reflection = program->reflection;
+
+  reflection.uniforms = reflect_variables(program->id, GL_UNIFORM);
+  reflection.attributes = reflect_variables(program->id, GL_PROGRAM_INPUT);
+  reflection.uniform_blocks = reflect_blocks(program->id, GL_UNIFORM_BLOCK);
+  reflection.storage_blocks = reflect_blocks(program->id, GL_SHADER_STORAGE_BLOCK);
+
+  reflection.uniform_locations_.clear();
+  for (const auto& uniform : reflection.uniforms) {
+    reflection.uniform_locations_.emplace(uniform.name, uniform.location);
+
+    // Arrays are reported as "name[0]"; allow looking them up by "name" as well.
+    if (uniform.name.size() > 3 && uniform.name.compare(uniform.name.size() - 3, 3, "[0]") == 0) {
+      reflection.uniform_locations_.emplace(uniform.name.substr(0, uniform.name.size() - 3),
+                                            uniform.location);
+    }
+  }
+}
+
+size_t ShaderCache::reload_changed() {
+  auto now = Clock::now();
+  if (now - last_poll_ < kPollInterval) {
+    return 0;
+  }
+  last_poll_ = now;
+
+  size_t reloaded = 0;
+  for (auto& program : programs_) {
+    bool changed = false;
+    for (size_t i = 0; i < program->dependencies.size(); ++i) {
+      std::error_code ec;
+      if (fs::last_write_time(program->dependencies[i], ec) != program->dependency_times[i]) {
+        changed = true;
+        break;
+      }
+    }
+
+    if (!changed) {
+      continue;
+    }
+
+    std::cout << "Reloading " << program->vertex_path << " + " << program->fragment_path << '\n';
+    if (build(program.get())) {
+      ++reloaded;
+    } else {
+      // Do not retry until the files change again.
+      for (size_t i = 0; i < program->dependencies.size(); ++i) {
+        std::error_code ec;
+        program->dependency_times[i] = fs::last_write_time(program->dependencies[i], ec);
+      }
+    }
+  }
+
+  return reloaded;
+}
+
+void ShaderCache::destroy() {
+  for (auto& program : programs_) {
+    if (program->id) {
+      glDeleteProgram(program->id);
+      program->id = 0;
+    }
+  }
+  programs_.clear();
+}
+
+void ShaderCache::print_stats() const {
+  size_t lookups = stats_.binary_hits + stats_.binary_misses;
+  double hit_rate = lookups ? 100.0 * double(stats_.binary_hits) / double(lookups) : 0.0;
+
+  std::cout << "Shaders: " << stats_.programs << " programs, binary cache hits "
+            << stats_.binary_hits << '/' << lookups << " (" << hit_rate << "%), compile "
+            << stats_.compile_ms << " ms, link " << stats_.link_ms << " ms, binary load "
+            << stats_.binary_load_ms << " ms\n";
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Everything the linker kept active in a program, queried once after linking.
+struct ShaderReflection {
+  struct Variable {
+    std::string name;
+    GLint location;
+    GLenum type;
+    GLint array_size;
+  };
+
+  struct Block {
+    std::string name;
+    GLuint index;
+    GLint binding;
+    GLint data_size;
+  };
+
+  std::vector<Variable> uniforms;
+  std::vector<Variable> attributes;
+  std::vector<Block> uniform_blocks;
+  std::vector<Block> storage_blocks;
+
+  // Returns -1 for unknown or inactive uniforms.
+  GLint uniform_location(std::string_view name) const;
+  GLint attribute_location(std::string_view name) const;
+
+private:
+  friend class ShaderCache;
+
+  std::unordered_map<std::string, GLint> uniform_locations_;
+};
+
+struct ShaderProgram {
+  GLuint id = 0;
+  ShaderReflection reflection;
+  // Incremented every time the program is rebuilt by a hot reload.  Uniform values do not survive
+  // a reload and need to be set again.
+  uint32_t generation = 0;
+
+  std::string vertex_path;
+  std::string fragment_path;
+  std::vector<std::filesystem::path> dependencies;
+  std::vector<std::filesystem::file_time_type> dependency_times;
+};
+
+struct ShaderCacheStats {
+  size_t programs = 0;
+  size_t binary_hits = 0;
+  size_t binary_misses = 0;
+  double compile_ms = 0.0;
+  double link_ms = 0.0;
+  double binary_load_ms = 0.0;
+};
+
+// Builds shader programs from files and keeps them up to date.
+//
+// Linked programs are stored in `cache_dir` with `glGetProgramBinary`, keyed by a hash of the
+// preprocessed sources and the driver, so warm starts skip compilation entirely.  Programs
+// returned by `load` stay owned by the cache and keep their address across hot reloads.
+class ShaderCache {
+public:
+  explicit ShaderCache(std::string cache_dir);
+  ~ShaderCache();
+
+  ShaderCache(const ShaderCache&) = delete;
+  ShaderCache& operator=(const ShaderCache&) = delete;
+
+  // Returns nullptr if the program could not be built.
+  ShaderProgram* load(const std::string& vertex_path, const std::string& fragment_path);
+
+  // Rebuilds programs whose source files changed.  Checks the file system at most every
+  // `kPollInterval`.  Programs that fail to build keep their previous version.  Returns the number
+  // of programs that were rebuilt.
+  size_t reload_changed();
+
+  void destroy();
+
+  const ShaderCacheStats& stats() const {
+    return stats_;
+  }
+
+  void print_stats() const;
+
+private:
+  static constexpr std::chrono::milliseconds kPollInterval{250};
+
+  bool build(ShaderProgram* program);
+  GLuint load_binary(uint64_t key);
+  void store_binary(uint64_t key, GLuint program);
+  void reflect(ShaderProgram* program);
+
+  std::string cache_dir_;
+  bool binaries_supported_ = false;
+  std::string driver_id_;
+  std::vector<std::unique_ptr<ShaderProgram>> programs_;
+  std::chrono::steady_clock::time_point last_poll_;
+  ShaderCacheStats stats_;
+};
@@ -0,0 +1,75 @@
+#include "shader_source.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool expand(const fs::path& path, int depth, std::string* out,
+            std::vector<std::string>* dependencies) {
+  constexpr int kMaxIncludeDepth = 16;
+  if (depth > kMaxIncludeDepth) {
+    std::cerr << "Shader includes nested too deeply at " << path.string() << '\n';
+    return false;
+  }
+
+  // Files are numbered in the order they are first read; the number is the source string number
+  // of the `#line` directives below.
+  const std::string source_number = std::to_string(dependencies->size());
+  dependencies->push_back(path.lexically_normal().generic_string());
+
+  std::ifstream stream{path};
+  if (!stream) {
+    std::cerr << "Could not open shader " << path.string() << '\n';
+    return false;
+  }
+
+  std::string line;
+  int line_number = 0;
+  while (std::getline(stream, line)) {
+    ++line_number;
+
+    size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+      *out += line;
+      *out += '\n';
+      continue;
+    }
+
+    size_t open = line.find('"', start + 8);
+    size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+    if (close == std::string::npos) {
+      std::cerr << path.string() << ':' << line_number << ": malformed #include\n";
+      return false;
+    }
+
+    fs::path include = path.parent_path() / line.substr(open + 1, close - open - 1);
+    std::string normalized = include.lexically_normal().generic_string();
+    if (std::find(dependencies->begin(), dependencies->end(), normalized) ==
+        dependencies->end()) {
+      *out += "#line 1 " + std::to_string(dependencies->size()) + '\n';
+      if (!expand(include, depth + 1, out, dependencies)) {
+        return false;
+      }
+    }
+
+    // Continue numbering from the line after the #include.
+    *out += "#line " + std::to_string(line_number + 1) + ' ' + source_number + '\n';
+  }
+
+  return true;
+}
+
+}  // namespace
+
+bool load_shader_source(const std::string& path, std::string* source,
+                        std::vector<std::string>* dependencies) {
+  source->clear();
+  dependencies->clear();
+  return expand(fs::path{path}, 0, source, dependencies);
+}
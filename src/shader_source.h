@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Loads a GLSL source file and expands `#include "file"` directives.  Included paths are resolved
+// relative to the including file and each file is included at most once.  `dependencies` receives
+// every file that was read, starting with `path` itself.  `#line` directives are emitted so
+// compiler messages keep pointing at the right lines; their source string number is the file's
+// index in `dependencies`, so an error at "2:15" is on line 15 of `(*dependencies)[2]`.
+bool load_shader_source(const std::string& path, std::string* source,
+                        std::vector<std::string>* dependencies);
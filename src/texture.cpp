@@ -0,0 +1,191 @@
+#include "texture.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <stb_image.h>
+
+#include "gl_error.h"
+#include "profiler.h"
+
+namespace {
+
+GLenum gl_format(BlockFormat format) {
+  switch (format) {
+    case BlockFormat::kBC1:
+      return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case BlockFormat::kBC3:
+      return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::kBC7:
+      return GL_COMPRESSED_RGBA_BPTC_UNORM;
+  }
+  return GL_NONE;
+}
+
+}  // namespace
+
+Texture load_texture(std::string_view path) {
+  Texture result{};
+
+  int channels = 0;
+  auto* image = stbi_load(path.data(), &result.width, &result.height, &channels, 4);
+
+  std::cout << "Image: width(" << result.width << "), height(" << result.height << "), channels("
+            << channels << ")\n";
+
+  glGenTextures(1, &result.texture_id);
+  GLError();
+
+  glBindTexture(GL_TEXTURE_2D, result.texture_id);
+  GLError();
+
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, result.width, result.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+               image);
+  GLError();
+  PROFILE_COUNT(kTextureUploads, 1);
+  PROFILE_COUNT(kUploadBytes, size_t(result.width) * size_t(result.height) * 4);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  GLError();
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  GLError();
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  stbi_image_free(image);
+
+  return result;
+}
+
+Texture load_texture(const AssetPack& pack, std::string_view name) {
+  Texture result{};
+
+  const AssetPackEntry* entry = pack.find(name);
+  if (!entry || entry->type != AssetType::kImage) {
+    std::cerr << "Image " << name << " is not in the asset pack.\n";
+    return result;
+  }
+
+  result.width = int(entry->width);
+  result.height = int(entry->height);
+
+  glGenTextures(1, &result.texture_id);
+  glBindTexture(GL_TEXTURE_2D, result.texture_id);
+  glTexStorage2D(GL_TEXTURE_2D, GLsizei(entry->mip_count), GL_RGBA8, result.width, result.height);
+  GLError();
+
+  const uint8_t* data = pack.data(*entry);
+  for (uint32_t level = 0; level < entry->mip_count; ++level) {
+    GLsizei width = std::max(result.width >> level, 1);
+    GLsizei height = std::max(result.height >> level, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, GLint(level), 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                    data);
+    data += mip_level_size(entry->width, entry->height, level);
+  }
+  GLError();
+  PROFILE_COUNT(kTextureUploads, entry->mip_count);
+  PROFILE_COUNT(kUploadBytes, entry->data_size);
+
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  entry->mip_count > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+  GLError();
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  return result;
+}
+
+bool compressed_format_supported(BlockFormat format) {
+  switch (format) {
+    case BlockFormat::kBC1:
+    case BlockFormat::kBC3:
+      return GLEW_EXT_texture_compression_s3tc;
+    case BlockFormat::kBC7:
+      return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+  }
+  return false;
+}
+
+Texture load_texture(const CompressedImage& image) {
+  Texture result{};
+
+  if (!compressed_format_supported(image.format)) {
+    std::cerr << block_format_name(image.format) << " textures are not supported.\n";
+    return result;
+  }
+
+  result.width = image.width;
+  result.height = image.height;
+
+  glGenTextures(1, &result.texture_id);
+  glBindTexture(GL_TEXTURE_2D, result.texture_id);
+  for (size_t level = 0; level < image.levels.size(); ++level) {
+    const CompressedImage::Level& l = image.levels[level];
+    glCompressedTexImage2D(GL_TEXTURE_2D, GLint(level), gl_format(image.format), l.width, l.height,
+                           0, GLsizei(l.size), image.level_data(level));
+  }
+  GLError();
+  PROFILE_COUNT(kTextureUploads, image.levels.size());
+  PROFILE_COUNT(kUploadBytes, image.data.size());
+
+  // Files may stop before the 1x1 level; without this the texture would be incomplete.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, GLint(image.levels.size()) - 1);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  image.levels.size() > 1 ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST);
+  GLError();
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  return result;
+}
+
+Texture load_compressed_texture(std::string_view path) {
+  CompressedImage image;
+  if (!load_compressed_image(path, &image)) {
+    return {};
+  }
+
+  return load_texture(image);
+}
+
+Texture load_texture(std::string_view path, BlockFormat format, bool mips) {
+  Image image;
+  if (!load_image(path, &image)) {
+    return {};
+  }
+
+  CompressedImage compressed;
+  compress_image(image, format, best_encoder_path(), mips, &compressed);
+
+  return load_texture(compressed);
+}
+
+bool load_texture(const std::vector<std::string>& paths, const AtlasOptions& options,
+                  TextureAtlas* atlas, std::vector<AtlasHandle>* handles) {
+  std::vector<Image> images(paths.size());
+  std::vector<const Image*> decoded;
+  std::vector<size_t> decoded_paths;
+  for (size_t i = 0; i < paths.size(); ++i) {
+    if (load_image(paths[i], &images[i])) {
+      decoded.push_back(&images[i]);
+      decoded_paths.push_back(i);
+    }
+  }
+
+  handles->assign(paths.size(), {});
+  std::vector<AtlasHandle> decoded_handles;
+  if (decoded.empty() || !atlas->build(decoded, options, &decoded_handles)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < decoded_paths.size(); ++i) {
+    (*handles)[decoded_paths[i]] = decoded_handles[i];
+  }
+  PROFILE_COUNT(kTextureUploads, size_t(atlas->page_count()));
+
+  return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "asset_pack.h"
+#include "compressed_image.h"
+#include "image.h"
+#include "texture_atlas.h"
+
+struct Texture {
+  GLuint texture_id;
+  int width;
+  int height;
+};
+
+Texture load_texture(std::string_view path);
+
+// Uploads a cooked image, including its mip chain, straight from the mapped pack.  Returns a
+// texture with `texture_id == 0` if `name` is not an image in `pack`.
+Texture load_texture(const AssetPack& pack, std::string_view name);
+
+// True if the driver can sample `format`.  BC1 and BC3 need EXT_texture_compression_s3tc, BC7 is
+// core since OpenGL 4.2.
+bool compressed_format_supported(BlockFormat format);
+
+// Uploads a block compressed image, including its mip chain, with glCompressedTexImage2D.  Returns
+// a texture with `texture_id == 0` if the format is not supported.
+Texture load_texture(const CompressedImage& image);
+
+// Loads a pre-compressed DDS or KTX2 file.
+Texture load_compressed_texture(std::string_view path);
+
+// Decodes the image at `path` and compresses it to `format` on the CPU before uploading.  Costs
+// load time but uses 1/8 (BC1) or 1/4 (BC3, BC7) of the memory of the RGBA8 upload.
+Texture load_texture(std::string_view path, BlockFormat format, bool mips);
+
+// Decodes the images at `paths` and packs them into the pages of `atlas`, so sprites drawn from it
+// share a texture and batch together.  `handles` receives one entry per path, in the same order;
+// images that could not be decoded or do not fit in a page get a handle with `texture == 0`.
+bool load_texture(const std::vector<std::string>& paths, const AtlasOptions& options,
+                  TextureAtlas* atlas, std::vector<AtlasHandle>* handles);
@@ -0,0 +1,154 @@
+#include "texture_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "gl_error.h"
+
+namespace {
+
+// Copies `image` into `page` at `rect` and extends its edge texels `padding` texels outwards.
+void blit_with_gutter(const Image& image, const AtlasRect& rect, int padding, int page_width,
+                      uint8_t* page) {
+  for (int y = -padding; y < rect.height + padding; ++y) {
+    int src_y = std::clamp(y, 0, image.height - 1);
+    for (int x = -padding; x < rect.width + padding; ++x) {
+      int src_x = std::clamp(x, 0, image.width - 1);
+      const uint8_t* src = image.pixels.data() + (size_t(src_y) * image.width + src_x) * 4;
+      uint8_t* dst = page + (size_t(rect.y + y) * page_width + (rect.x + x)) * 4;
+      std::memcpy(dst, src, 4);
+    }
+  }
+}
+
+void set_sampling(GLenum target, int mip_levels) {
+  glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(target, GL_TEXTURE_MIN_FILTER,
+                  mip_levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST);
+  glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, mip_levels - 1);
+  GLError();
+
+  if (mip_levels > 1) {
+    glGenerateMipmap(target);
+    GLError();
+  }
+}
+
+}  // namespace
+
+TextureAtlas::~TextureAtlas() {
+  destroy();
+}
+
+bool TextureAtlas::build(const std::vector<const Image*>& images, const AtlasOptions& options,
+                         std::vector<AtlasHandle>* handles) {
+  destroy();
+
+  backend_ = options.backend;
+
+  int mip_levels = std::max(options.mip_levels, 1);
+  int max_mip_levels = 1;
+  while ((std::max(options.page_width, options.page_height) >> max_mip_levels) != 0) {
+    ++max_mip_levels;
+  }
+  mip_levels = std::min(mip_levels, max_mip_levels);
+  const int padding = std::max(options.padding, 1 << (mip_levels - 1));
+
+  std::vector<AtlasRect> sizes(images.size());
+  for (size_t i = 0; i < images.size(); ++i) {
+    sizes[i].width = images[i]->width;
+    sizes[i].height = images[i]->height;
+  }
+
+  AtlasPackResult packed =
+      pack_atlas(sizes, options.page_width, options.page_height, padding);
+  page_count_ = packed.page_count;
+  efficiency_ = packed.efficiency;
+
+  if (page_count_ == 0) {
+    std::cerr << "No images fit in the atlas.\n";
+    return false;
+  }
+
+  const GLenum target = this->target();
+
+  if (backend_ == AtlasBackend::kTextureArray) {
+    textures_.resize(1);
+    glGenTextures(1, textures_.data());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textures_[0]);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, mip_levels, GL_RGBA8, options.page_width,
+                   options.page_height, page_count_);
+    GLError();
+  } else {
+    textures_.resize(size_t(page_count_));
+    glGenTextures(GLsizei(textures_.size()), textures_.data());
+    GLError();
+  }
+
+  // Compose and upload one page at a time so only a single page lives in memory.
+  std::vector<uint8_t> page(size_t(options.page_width) * size_t(options.page_height) * 4);
+
+  for (int page_index = 0; page_index < page_count_; ++page_index) {
+    std::fill(page.begin(), page.end(), 0);
+
+    for (size_t i = 0; i < images.size(); ++i) {
+      if (packed.placements[i].page == page_index) {
+        blit_with_gutter(*images[i], packed.placements[i].rect, padding,
+                         options.page_width, page.data());
+      }
+    }
+
+    if (backend_ == AtlasBackend::kTextureArray) {
+      glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, page_index, options.page_width,
+                      options.page_height, 1, GL_RGBA, GL_UNSIGNED_BYTE, page.data());
+      GLError();
+    } else {
+      glBindTexture(GL_TEXTURE_2D, textures_[size_t(page_index)]);
+      glTexStorage2D(GL_TEXTURE_2D, mip_levels, GL_RGBA8, options.page_width,
+                     options.page_height);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, options.page_width, options.page_height, GL_RGBA,
+                      GL_UNSIGNED_BYTE, page.data());
+      GLError();
+      set_sampling(GL_TEXTURE_2D, mip_levels);
+    }
+  }
+
+  if (backend_ == AtlasBackend::kTextureArray) {
+    set_sampling(GL_TEXTURE_2D_ARRAY, mip_levels);
+  }
+
+  glBindTexture(target, 0);
+
+  handles->resize(images.size());
+  for (size_t i = 0; i < images.size(); ++i) {
+    const AtlasPlacement& placement = packed.placements[i];
+    AtlasHandle& handle = (*handles)[i];
+    if (placement.page < 0) {
+      handle = {};
+      continue;
+    }
+
+    const AtlasRect& rect = placement.rect;
+    handle.texture = backend_ == AtlasBackend::kTextureArray ? textures_[0]
+                                                              : textures_[size_t(placement.page)];
+    handle.layer = backend_ == AtlasBackend::kTextureArray ? placement.page : 0;
+    handle.uv_rect = {float(rect.x) / float(options.page_width),
+                      float(rect.y) / float(options.page_height),
+                      float(rect.x + rect.width) / float(options.page_width),
+                      float(rect.y + rect.height) / float(options.page_height)};
+  }
+
+  return true;
+}
+
+void TextureAtlas::destroy() {
+  if (!textures_.empty()) {
+    glDeleteTextures(GLsizei(textures_.size()), textures_.data());
+    textures_.clear();
+  }
+  page_count_ = 0;
+  efficiency_ = 0.0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "atlas_packer.h"
+#include "image.h"
+
+enum class AtlasBackend {
+  // One GL_TEXTURE_2D per page.  Works with the batch renderer directly.
+  kTexturePages,
+  // All pages are layers of a single GL_TEXTURE_2D_ARRAY.  Shaders select the page with `layer`.
+  kTextureArray,
+};
+
+struct AtlasOptions {
+  int page_width = 2048;
+  int page_height = 2048;
+  // Gutter around every image, filled by repeating its edge texels.  `build` raises it to
+  // `1 << (mip_levels - 1)` so no texel of the smallest level covers two images.
+  int padding = 2;
+  // 1 disables mipmapping.  Clamped to the full mip chain of a page.
+  int mip_levels = 1;
+  AtlasBackend backend = AtlasBackend::kTexturePages;
+};
+
+// Where an image ended up in the atlas.  `uv_rect` holds (u0, v0, u1, v1).
+struct AtlasHandle {
+  GLuint texture = 0;
+  int layer = 0;
+  glm::vec4 uv_rect{0.0f};
+};
+
+// Packs many small images into a few shared pages so they can be drawn without texture binds in
+// between.
+class TextureAtlas {
+public:
+  TextureAtlas() = default;
+  ~TextureAtlas();
+
+  TextureAtlas(const TextureAtlas&) = delete;
+  TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+  // Packs and uploads `images`.  `handles` receives one entry per image, in the same order.  Images
+  // that do not fit in a page get a handle with `texture == 0`.
+  bool build(const std::vector<const Image*>& images, const AtlasOptions& options,
+             std::vector<AtlasHandle>* handles);
+  void destroy();
+
+  GLenum target() const {
+    return backend_ == AtlasBackend::kTextureArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+  }
+
+  int page_count() const {
+    return page_count_;
+  }
+
+  double efficiency() const {
+    return efficiency_;
+  }
+
+private:
+  AtlasBackend backend_ = AtlasBackend::kTexturePages;
+  std::vector<GLuint> textures_;
+  int page_count_ = 0;
+  double efficiency_ = 0.0;
+};
@@ -0,0 +1,752 @@
+#include "texture_compression.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CORE_GRAPHICS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int kTexelCount = 16;
+
+// BC7 interpolation weights for 4 bit indices, out of 64.
+constexpr int kBC7Weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BlockBounds {
+  int min[4];
+  int max[4];
+  // Sum over the texels of (2 * texel - (min + max)) for each channel times the same for the
+  // reference channel, the one with the largest extent.  Only the sign is used.
+  int covariance[4];
+};
+
+using Palette = int[16][4];
+
+int reference_channel(const BlockBounds& bounds, int channels) {
+  int reference = 0;
+  for (int c = 1; c < channels; ++c) {
+    if (bounds.max[c] - bounds.min[c] > bounds.max[reference] - bounds.min[reference]) {
+      reference = c;
+    }
+  }
+  return reference;
+}
+
+void bounds_scalar(const uint8_t* texels, int channels, BlockBounds* bounds) {
+  for (int c = 0; c < 4; ++c) {
+    bounds->min[c] = 255;
+    bounds->max[c] = 0;
+    bounds->covariance[c] = 0;
+  }
+  for (int i = 0; i < kTexelCount; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      bounds->min[c] = std::min(bounds->min[c], int(texels[i * 4 + c]));
+      bounds->max[c] = std::max(bounds->max[c], int(texels[i * 4 + c]));
+    }
+  }
+
+  int reference = reference_channel(*bounds, channels);
+  for (int i = 0; i < kTexelCount; ++i) {
+    const uint8_t* texel = texels + i * 4;
+    int r = 2 * texel[reference] - (bounds->min[reference] + bounds->max[reference]);
+    for (int c = 0; c < channels; ++c) {
+      bounds->covariance[c] += (2 * texel[c] - (bounds->min[c] + bounds->max[c])) * r;
+    }
+  }
+}
+
+int squared_distance(const uint8_t* texel, const int* color, int channels) {
+  int distance = 0;
+  for (int c = 0; c < channels; ++c) {
+    int d = int(texel[c]) - color[c];
+    distance += d * d;
+  }
+  return distance;
+}
+
+// Index of the closest palette entry for every texel; ties go to the lower index.
+void select_indices_scalar(const uint8_t* texels, const Palette& palette, int palette_size,
+                           int channels, uint8_t* indices) {
+  for (int i = 0; i < kTexelCount; ++i) {
+    const uint8_t* texel = texels + i * 4;
+    int best = squared_distance(texel, palette[0], channels);
+    indices[i] = 0;
+    for (int p = 1; p < palette_size; ++p) {
+      int distance = squared_distance(texel, palette[p], channels);
+      if (distance < best) {
+        best = distance;
+        indices[i] = uint8_t(p);
+      }
+    }
+  }
+}
+
+void select_alpha_indices_scalar(const uint8_t* texels, const int* palette, uint8_t* indices) {
+  for (int i = 0; i < kTexelCount; ++i) {
+    int alpha = texels[i * 4 + 3];
+    int best = std::abs(alpha - palette[0]);
+    indices[i] = 0;
+    for (int p = 1; p < 8; ++p) {
+      int distance = std::abs(alpha - palette[p]);
+      if (distance < best) {
+        best = distance;
+        indices[i] = uint8_t(p);
+      }
+    }
+  }
+}
+
+#if defined(CORE_GRAPHICS_SSE2)
+
+// A block as one float register per channel for every group of four texels.
+struct SoaBlock {
+  __m128 channels[4][4];
+};
+
+void load_soa(const uint8_t* texels, SoaBlock* block) {
+  const __m128i byte_mask = _mm_set1_epi32(0xff);
+  for (int g = 0; g < 4; ++g) {
+    __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + g * 16));
+    block->channels[0][g] = _mm_cvtepi32_ps(_mm_and_si128(t, byte_mask));
+    block->channels[1][g] = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(t, 8), byte_mask));
+    block->channels[2][g] = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(t, 16), byte_mask));
+    block->channels[3][g] = _mm_cvtepi32_ps(_mm_srli_epi32(t, 24));
+  }
+}
+
+float horizontal_sum(__m128 v) {
+  v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtss_f32(v);
+}
+
+// Same results as `bounds_scalar`: every partial covariance sum is an integer well below 2^24, so
+// the float arithmetic is exact.
+void bounds_sse(const uint8_t* texels, const SoaBlock& block, int channels,
+                BlockBounds* bounds) {
+  const auto* rows = reinterpret_cast<const __m128i*>(texels);
+  __m128i t0 = _mm_loadu_si128(rows);
+  __m128i t1 = _mm_loadu_si128(rows + 1);
+  __m128i t2 = _mm_loadu_si128(rows + 2);
+  __m128i t3 = _mm_loadu_si128(rows + 3);
+
+  __m128i low = _mm_min_epu8(_mm_min_epu8(t0, t1), _mm_min_epu8(t2, t3));
+  __m128i high = _mm_max_epu8(_mm_max_epu8(t0, t1), _mm_max_epu8(t2, t3));
+  low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+  low = _mm_min_epu8(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+  high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+  high = _mm_max_epu8(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+
+  auto low_bits = uint32_t(_mm_cvtsi128_si32(low));
+  auto high_bits = uint32_t(_mm_cvtsi128_si32(high));
+  for (int c = 0; c < 4; ++c) {
+    bounds->min[c] = int((low_bits >> (c * 8)) & 0xff);
+    bounds->max[c] = int((high_bits >> (c * 8)) & 0xff);
+    bounds->covariance[c] = 0;
+  }
+
+  int reference = reference_channel(*bounds, channels);
+  __m128 centers[4];
+  for (int c = 0; c < 4; ++c) {
+    centers[c] = _mm_set1_ps(float(bounds->min[c] + bounds->max[c]));
+  }
+
+  for (int c = 0; c < channels; ++c) {
+    __m128 sum = _mm_setzero_ps();
+    for (int g = 0; g < 4; ++g) {
+      __m128 r = _mm_sub_ps(_mm_add_ps(block.channels[reference][g], block.channels[reference][g]),
+                            centers[reference]);
+      __m128 v = _mm_sub_ps(_mm_add_ps(block.channels[c][g], block.channels[c][g]), centers[c]);
+      sum = _mm_add_ps(sum, _mm_mul_ps(v, r));
+    }
+    bounds->covariance[c] = int(horizontal_sum(sum));
+  }
+}
+
+void select_indices_sse(const SoaBlock& block, const Palette& palette, int palette_size,
+                        int channels, uint8_t* indices) {
+  for (int g = 0; g < 4; ++g) {
+    __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128i best_index = _mm_setzero_si128();
+    for (int p = 0; p < palette_size; ++p) {
+      __m128 distance = _mm_setzero_ps();
+      for (int c = 0; c < channels; ++c) {
+        __m128 d = _mm_sub_ps(block.channels[c][g], _mm_set1_ps(float(palette[p][c])));
+        distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+      }
+      __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+      best = _mm_min_ps(distance, best);
+      best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(p)),
+                                _mm_andnot_si128(closer, best_index));
+    }
+
+    alignas(16) int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), best_index);
+    for (int i = 0; i < 4; ++i) {
+      indices[g * 4 + i] = uint8_t(lanes[i]);
+    }
+  }
+}
+
+// All 16 alpha values fit one register, so this works on bytes: |a - p| is
+// saturate(a - p) | saturate(p - a).
+void select_alpha_indices_sse(const uint8_t* texels, const int* palette, uint8_t* indices) {
+  const auto* rows = reinterpret_cast<const __m128i*>(texels);
+  __m128i alpha01 = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(rows), 24),
+                                    _mm_srli_epi32(_mm_loadu_si128(rows + 1), 24));
+  __m128i alpha23 = _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(rows + 2), 24),
+                                    _mm_srli_epi32(_mm_loadu_si128(rows + 3), 24));
+  __m128i alpha = _mm_packus_epi16(alpha01, alpha23);
+
+  auto distance = [alpha](int value) {
+    __m128i p = _mm_set1_epi8(char(value));
+    return _mm_or_si128(_mm_subs_epu8(alpha, p), _mm_subs_epu8(p, alpha));
+  };
+
+  __m128i best = distance(palette[0]);
+  __m128i best_index = _mm_setzero_si128();
+  for (int p = 1; p < 8; ++p) {
+    __m128i d = distance(palette[p]);
+    __m128i closer = _mm_andnot_si128(_mm_cmpeq_epi8(d, best),
+                                      _mm_cmpeq_epi8(_mm_min_epu8(d, best), d));
+    best = _mm_min_epu8(d, best);
+    best_index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi8(char(p))),
+                              _mm_andnot_si128(closer, best_index));
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), best_index);
+}
+
+#endif
+
+// Per texel work of one block for the chosen path.
+class BlockAnalyzer {
+public:
+  BlockAnalyzer(EncoderPath path, const uint8_t* texels) : texels_{texels} {
+#if defined(CORE_GRAPHICS_SSE2)
+    sse_ = path == EncoderPath::kSse;
+    if (sse_) {
+      load_soa(texels, &soa_);
+    }
+#else
+    (void)path;
+#endif
+  }
+
+  void bounds(int channels, BlockBounds* bounds) const {
+#if defined(CORE_GRAPHICS_SSE2)
+    if (sse_) {
+      bounds_sse(texels_, soa_, channels, bounds);
+      return;
+    }
+#endif
+    bounds_scalar(texels_, channels, bounds);
+  }
+
+  void select_indices(const Palette& palette, int palette_size, int channels,
+                      uint8_t* indices) const {
+#if defined(CORE_GRAPHICS_SSE2)
+    if (sse_) {
+      select_indices_sse(soa_, palette, palette_size, channels, indices);
+      return;
+    }
+#endif
+    select_indices_scalar(texels_, palette, palette_size, channels, indices);
+  }
+
+  void select_alpha_indices(const int* palette, uint8_t* indices) const {
+#if defined(CORE_GRAPHICS_SSE2)
+    if (sse_) {
+      select_alpha_indices_sse(texels_, palette, indices);
+      return;
+    }
+#endif
+    select_alpha_indices_scalar(texels_, palette, indices);
+  }
+
+private:
+  const uint8_t* texels_;
+#if defined(CORE_GRAPHICS_SSE2)
+  bool sse_ = false;
+  SoaBlock soa_;
+#endif
+};
+
+// Picks the bounding box diagonal that follows the texels and moves both ends towards each other
+// by 1/`inset` of the box, which lowers the error of the texels near the middle.
+void select_endpoints(const BlockBounds& bounds, int channels, int inset, int* e0, int* e1) {
+  for (int c = 0; c < channels; ++c) {
+    int low = bounds.min[c];
+    int high = bounds.max[c];
+    int d = (high - low) / inset;
+    if (bounds.covariance[c] < 0) {
+      e0[c] = low + d;
+      e1[c] = high - d;
+    } else {
+      e0[c] = high - d;
+      e1[c] = low + d;
+    }
+  }
+}
+
+uint16_t to_565(const int* color) {
+  int r = (color[0] * 31 + 127) / 255;
+  int g = (color[1] * 63 + 127) / 255;
+  int b = (color[2] * 31 + 127) / 255;
+  return uint16_t((r << 11) | (g << 5) | b);
+}
+
+void from_565(uint16_t value, int* color) {
+  int r = value >> 11;
+  int g = (value >> 5) & 63;
+  int b = value & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+  color[3] = 255;
+}
+
+void write_u16(uint16_t value, uint8_t* out) {
+  out[0] = uint8_t(value);
+  out[1] = uint8_t(value >> 8);
+}
+
+void write_u32(uint32_t value, uint8_t* out) {
+  for (int i = 0; i < 4; ++i) {
+    out[i] = uint8_t(value >> (i * 8));
+  }
+}
+
+// The BC1 color part.  BC3 always decodes it in four color mode, so `punch_through` (texels with
+// alpha below 128 become transparent black) is only allowed for BC1.
+void encode_color_block(EncoderPath path, const uint8_t* texels, bool punch_through,
+                        uint8_t* out) {
+  bool transparent[kTexelCount] = {};
+  int first_opaque = -1;
+  for (int i = 0; i < kTexelCount; ++i) {
+    transparent[i] = punch_through && texels[i * 4 + 3] < 128;
+    if (!transparent[i] && first_opaque < 0) {
+      first_opaque = i;
+    }
+  }
+  if (first_opaque < 0) {
+    write_u16(0, out);
+    write_u16(0, out + 2);
+    write_u32(0xffffffff, out + 4);
+    return;
+  }
+
+  // Transparent texels take the color of an opaque one so they do not stretch the endpoints.
+  const bool three_color = std::find(transparent, transparent + kTexelCount, true) !=
+                           transparent + kTexelCount;
+  uint8_t opaque[kTexelCount * 4];
+  if (three_color) {
+    std::memcpy(opaque, texels, sizeof(opaque));
+    for (int i = 0; i < kTexelCount; ++i) {
+      if (transparent[i]) {
+        std::memcpy(opaque + i * 4, texels + first_opaque * 4, 4);
+      }
+    }
+    texels = opaque;
+  }
+
+  BlockAnalyzer analyzer{path, texels};
+  BlockBounds bounds;
+  analyzer.bounds(3, &bounds);
+
+  int e0[4];
+  int e1[4];
+  select_endpoints(bounds, 3, 16, e0, e1);
+  uint16_t c0 = to_565(e0);
+  uint16_t c1 = to_565(e1);
+
+  // Four color blocks need c0 > c1 and three color blocks c0 <= c1.
+  if (three_color ? c0 > c1 : c0 < c1) {
+    std::swap(c0, c1);
+  }
+  write_u16(c0, out);
+  write_u16(c1, out + 2);
+  if (c0 == c1 && !three_color) {
+    write_u32(0, out + 4);
+    return;
+  }
+
+  Palette palette;
+  from_565(c0, palette[0]);
+  from_565(c1, palette[1]);
+  for (int c = 0; c < 3; ++c) {
+    if (three_color) {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+    } else {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+  }
+
+  uint8_t indices[kTexelCount];
+  analyzer.select_indices(palette, three_color ? 3 : 4, 3, indices);
+
+  uint32_t bits = 0;
+  for (int i = 0; i < kTexelCount; ++i) {
+    bits |= uint32_t(transparent[i] ? 3 : indices[i]) << (i * 2);
+  }
+  write_u32(bits, out + 4);
+}
+
+void alpha_palette(int a0, int a1, int* palette) {
+  palette[0] = a0;
+  palette[1] = a1;
+  if (a0 > a1) {
+    for (int i = 1; i < 7; ++i) {
+      palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    }
+  } else {
+    for (int i = 1; i < 5; ++i) {
+      palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+}
+
+void encode_alpha_block(EncoderPath path, const uint8_t* texels, uint8_t* out) {
+  int low = 255;
+  int high = 0;
+  for (int i = 0; i < kTexelCount; ++i) {
+    low = std::min(low, int(texels[i * 4 + 3]));
+    high = std::max(high, int(texels[i * 4 + 3]));
+  }
+
+  out[0] = uint8_t(high);
+  out[1] = uint8_t(low);
+  if (low == high) {
+    std::memset(out + 2, 0, 6);
+    return;
+  }
+
+  int palette[8];
+  alpha_palette(high, low, palette);
+
+  uint8_t indices[kTexelCount];
+  BlockAnalyzer{path, texels}.select_alpha_indices(palette, indices);
+
+  uint64_t bits = 0;
+  for (int i = 0; i < kTexelCount; ++i) {
+    bits |= uint64_t(indices[i]) << (i * 3);
+  }
+  for (int i = 0; i < 6; ++i) {
+    out[2 + i] = uint8_t(bits >> (i * 8));
+  }
+}
+
+class BitWriter {
+public:
+  explicit BitWriter(uint8_t* out) : out_{out} {
+    std::memset(out_, 0, 16);
+  }
+
+  void write(uint32_t value, int count) {
+    for (int i = 0; i < count; ++i, ++position_) {
+      out_[position_ / 8] |= uint8_t(((value >> i) & 1) << (position_ % 8));
+    }
+  }
+
+private:
+  uint8_t* out_;
+  int position_ = 0;
+};
+
+class BitReader {
+public:
+  explicit BitReader(const uint8_t* in) : in_{in} {}
+
+  uint32_t read(int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; ++i, ++position_) {
+      value |= uint32_t((in_[position_ / 8] >> (position_ % 8)) & 1) << i;
+    }
+    return value;
+  }
+
+private:
+  const uint8_t* in_;
+  int position_ = 0;
+};
+
+// Quantizes an 8 bit endpoint to 7 bits per channel plus the p-bit shared by its channels,
+// choosing the p-bit with the lower error.
+void quantize_bc7_endpoint(const int* endpoint, int* quantized, int* p_bit) {
+  int best_error = std::numeric_limits<int>::max();
+  for (int p = 0; p < 2; ++p) {
+    int q[4];
+    int error = 0;
+    for (int c = 0; c < 4; ++c) {
+      q[c] = std::min((endpoint[c] - p + 1) / 2, 127);
+      int d = (q[c] * 2 + p) - endpoint[c];
+      error += d * d;
+    }
+    if (error < best_error) {
+      best_error = error;
+      std::copy(q, q + 4, quantized);
+      *p_bit = p;
+    }
+  }
+}
+
+void encode_bc7_block(EncoderPath path, const uint8_t* texels, uint8_t* out) {
+  BlockAnalyzer analyzer{path, texels};
+  BlockBounds bounds;
+  analyzer.bounds(4, &bounds);
+
+  int e[2][4];
+  select_endpoints(bounds, 4, 32, e[0], e[1]);
+
+  int q[2][4];
+  int p[2];
+  quantize_bc7_endpoint(e[0], q[0], &p[0]);
+  quantize_bc7_endpoint(e[1], q[1], &p[1]);
+
+  Palette palette;
+  for (int i = 0; i < 16; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      int v0 = q[0][c] * 2 + p[0];
+      int v1 = q[1][c] * 2 + p[1];
+      palette[i][c] = ((64 - kBC7Weights[i]) * v0 + kBC7Weights[i] * v1 + 32) >> 6;
+    }
+  }
+
+  uint8_t indices[kTexelCount];
+  analyzer.select_indices(palette, 16, 4, indices);
+
+  // The first index is stored without its top bit, so it has to be below 8.  The weights are
+  // symmetric, so swapping the endpoints and mirroring the indices gives the same colors.
+  if (indices[0] & 8) {
+    std::swap(q[0], q[1]);
+    std::swap(p[0], p[1]);
+    for (auto& index : indices) {
+      index = uint8_t(15 - index);
+    }
+  }
+
+  BitWriter writer{out};
+  writer.write(1 << 6, 7);
+  for (int c = 0; c < 4; ++c) {
+    writer.write(uint32_t(q[0][c]), 7);
+    writer.write(uint32_t(q[1][c]), 7);
+  }
+  writer.write(uint32_t(p[0]), 1);
+  writer.write(uint32_t(p[1]), 1);
+  writer.write(indices[0], 3);
+  for (int i = 1; i < kTexelCount; ++i) {
+    writer.write(indices[i], 4);
+  }
+}
+
+void decode_color_block(const uint8_t* block, bool four_color, uint8_t* texels) {
+  uint16_t c0 = uint16_t(block[0] | (block[1] << 8));
+  uint16_t c1 = uint16_t(block[2] | (block[3] << 8));
+
+  Palette palette;
+  from_565(c0, palette[0]);
+  from_565(c1, palette[1]);
+  for (int c = 0; c < 3; ++c) {
+    if (four_color || c0 > c1) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    } else {
+      palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+      palette[3][c] = 0;
+    }
+  }
+  palette[2][3] = 255;
+  palette[3][3] = four_color || c0 > c1 ? 255 : 0;
+
+  uint32_t bits = uint32_t(block[4]) | uint32_t(block[5]) << 8 | uint32_t(block[6]) << 16 |
+                  uint32_t(block[7]) << 24;
+  for (int i = 0; i < kTexelCount; ++i) {
+    const int* color = palette[(bits >> (i * 2)) & 3];
+    for (int c = 0; c < 4; ++c) {
+      texels[i * 4 + c] = uint8_t(color[c]);
+    }
+  }
+}
+
+void decode_alpha_block(const uint8_t* block, uint8_t* texels) {
+  int palette[8];
+  alpha_palette(block[0], block[1], palette);
+
+  uint64_t bits = 0;
+  for (int i = 0; i < 6; ++i) {
+    bits |= uint64_t(block[2 + i]) << (i * 8);
+  }
+  for (int i = 0; i < kTexelCount; ++i) {
+    texels[i * 4 + 3] = uint8_t(palette[(bits >> (i * 3)) & 7]);
+  }
+}
+
+bool decode_bc7_block(const uint8_t* block, uint8_t* texels) {
+  if ((block[0] & 0x7f) != 0x40) {
+    return false;
+  }
+
+  BitReader reader{block};
+  reader.read(7);
+  int endpoints[2][4];
+  for (int c = 0; c < 4; ++c) {
+    endpoints[0][c] = int(reader.read(7)) * 2;
+    endpoints[1][c] = int(reader.read(7)) * 2;
+  }
+  int p0 = int(reader.read(1));
+  int p1 = int(reader.read(1));
+  for (int c = 0; c < 4; ++c) {
+    endpoints[0][c] |= p0;
+    endpoints[1][c] |= p1;
+  }
+
+  for (int i = 0; i < kTexelCount; ++i) {
+    int weight = kBC7Weights[reader.read(i == 0 ? 3 : 4)];
+    for (int c = 0; c < 4; ++c) {
+      texels[i * 4 + c] =
+          uint8_t(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+    }
+  }
+
+  return true;
+}
+
+}  // namespace
+
+const char* block_format_name(BlockFormat format) {
+  switch (format) {
+    case BlockFormat::kBC1:
+      return "BC1";
+    case BlockFormat::kBC3:
+      return "BC3";
+    case BlockFormat::kBC7:
+      return "BC7";
+  }
+  return "unknown";
+}
+
+bool parse_block_format(std::string_view name, BlockFormat* format) {
+  for (BlockFormat candidate : {BlockFormat::kBC1, BlockFormat::kBC3, BlockFormat::kBC7}) {
+    std::string_view candidate_name = block_format_name(candidate);
+    if (name.size() == candidate_name.size() &&
+        std::equal(name.begin(), name.end(), candidate_name.begin(),
+                   [](char a, char b) { return std::toupper(a) == b; })) {
+      *format = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+EncoderPath best_encoder_path() {
+#if defined(CORE_GRAPHICS_SSE2)
+  return EncoderPath::kSse;
+#else
+  return EncoderPath::kScalar;
+#endif
+}
+
+const char* encoder_path_name(EncoderPath path) {
+  switch (path) {
+    case EncoderPath::kScalar:
+      return "scalar";
+    case EncoderPath::kSse:
+      return "SSE2";
+  }
+  return "unknown";
+}
+
+void encode_block(BlockFormat format, EncoderPath path, const uint8_t* texels, uint8_t* block) {
+#if !defined(CORE_GRAPHICS_SSE2)
+  path = EncoderPath::kScalar;
+#endif
+  switch (format) {
+    case BlockFormat::kBC1:
+      encode_color_block(path, texels, true, block);
+      break;
+    case BlockFormat::kBC3:
+      encode_alpha_block(path, texels, block);
+      encode_color_block(path, texels, false, block + 8);
+      break;
+    case BlockFormat::kBC7:
+      encode_bc7_block(path, texels, block);
+      break;
+  }
+}
+
+bool decode_block(BlockFormat format, const uint8_t* block, uint8_t* texels) {
+  switch (format) {
+    case BlockFormat::kBC1:
+      decode_color_block(block, false, texels);
+      return true;
+    case BlockFormat::kBC3:
+      decode_color_block(block + 8, true, texels);
+      decode_alpha_block(block, texels);
+      return true;
+    case BlockFormat::kBC7:
+      return decode_bc7_block(block, texels);
+  }
+  return false;
+}
+
+void encode_image(const Image& image, BlockFormat format, EncoderPath path,
+                  std::vector<uint8_t>* blocks) {
+  const size_t block_size = block_bytes(format);
+  size_t offset = blocks->size();
+  blocks->resize(offset + compressed_size(format, image.width, image.height));
+
+  uint8_t texels[kTexelCount * 4];
+  for (int by = 0; by < image.height; by += 4) {
+    for (int bx = 0; bx < image.width; bx += 4) {
+      for (int y = 0; y < 4; ++y) {
+        int sy = std::min(by + y, image.height - 1);
+        const uint8_t* row = image.pixels.data() + size_t(sy) * size_t(image.width) * 4;
+        if (bx + 4 <= image.width) {
+          std::memcpy(texels + y * 16, row + size_t(bx) * 4, 16);
+          continue;
+        }
+        for (int x = 0; x < 4; ++x) {
+          int sx = std::min(bx + x, image.width - 1);
+          std::memcpy(texels + y * 16 + x * 4, row + size_t(sx) * 4, 4);
+        }
+      }
+
+      encode_block(format, path, texels, blocks->data() + offset);
+      offset += block_size;
+    }
+  }
+}
+
+bool decode_blocks(const uint8_t* blocks, BlockFormat format, int width, int height,
+                   Image* image) {
+  image->width = width;
+  image->height = height;
+  image->pixels.resize(size_t(width) * size_t(height) * 4);
+
+  uint8_t texels[kTexelCount * 4];
+  for (int by = 0; by < height; by += 4) {
+    for (int bx = 0; bx < width; bx += 4) {
+      if (!decode_block(format, blocks, texels)) {
+        return false;
+      }
+      blocks += block_bytes(format);
+
+      int columns = std::min(4, width - bx);
+      for (int y = 0; y < std::min(4, height - by); ++y) {
+        uint8_t* row = image->pixels.data() + (size_t(by + y) * size_t(width) + size_t(bx)) * 4;
+        std::memcpy(row, texels + y * 16, size_t(columns) * 4);
+      }
+    }
+  }
+
+  return true;
+}
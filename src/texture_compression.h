@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "image.h"
+
+// Block compressed texture formats.  Every format stores 4x4 texel blocks:
+//   BC1  8 bytes per block (4 bpp), RGB plus 1 bit alpha.
+//   BC3  16 bytes per block (8 bpp), BC1 color plus interpolated 8 bit alpha.
+//   BC7  16 bytes per block (8 bpp), RGBA.  The encoder only emits mode 6 (one subset, 7 bit
+//        endpoints plus p-bits, 4 bit indices); the decoder only understands mode 6.
+enum class BlockFormat : uint32_t {
+  kBC1 = 1,
+  kBC3 = 3,
+  kBC7 = 7,
+};
+
+const char* block_format_name(BlockFormat format);
+
+// Accepts "bc1", "bc3" and "bc7".
+bool parse_block_format(std::string_view name, BlockFormat* format);
+
+inline size_t block_bytes(BlockFormat format) {
+  return format == BlockFormat::kBC1 ? 8 : 16;
+}
+
+// Size of a `width` x `height` level, rounded up to whole blocks.
+inline size_t compressed_size(BlockFormat format, int width, int height) {
+  return size_t((width + 3) / 4) * size_t((height + 3) / 4) * block_bytes(format);
+}
+
+enum class EncoderPath {
+  kScalar,
+  kSse,
+};
+
+// SSE2 where the target guarantees it (every x86-64 CPU), scalar otherwise.
+EncoderPath best_encoder_path();
+
+const char* encoder_path_name(EncoderPath path);
+
+// Encodes 16 RGBA8 texels (a 4x4 block, row by row) into `block_bytes(format)` bytes.  Both paths
+// produce exactly the same blocks; the SSE path only runs the per-texel work four texels at a
+// time.
+//
+// Endpoints come from the bounding box of the block's colors, flipped along the diagonal that
+// follows the colors' covariance and inset slightly, then every texel picks the closest palette
+// entry.  That is fast enough for load time transcoding; offline tools wanting the best quality
+// would need an iterative endpoint search on top.
+void encode_block(BlockFormat format, EncoderPath path, const uint8_t* texels, uint8_t* block);
+
+// Decodes one block into 16 RGBA8 texels.  Returns false for BC7 modes other than 6.
+bool decode_block(BlockFormat format, const uint8_t* block, uint8_t* texels);
+
+// Appends the blocks of `image`, row of blocks by row of blocks.  Partial blocks at the right and
+// bottom edges repeat the last column and row.
+void encode_image(const Image& image, BlockFormat format, EncoderPath path,
+                  std::vector<uint8_t>* blocks);
+
+// Decodes a `width` x `height` level.
+bool decode_blocks(const uint8_t* blocks, BlockFormat format, int width, int height,
+                   Image* image);
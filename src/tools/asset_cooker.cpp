@@ -0,0 +1,264 @@
+// Cooks the contents of a resources directory into a binary asset pack (see asset_pack.h).
+//
+// Images are decoded to RGBA8 (optionally with a full mip chain), shaders and vertex blobs are
+// copied as-is.  If the output pack already exists, assets whose source file hash is unchanged are
+// copied over from it instead of being cooked again.
+//
+// Usage: asset-cooker <resources_dir> <output_pack> [--mips]
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "asset_pack.h"
+#include "hash.h"
+#include "image.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CookedAsset {
+  std::string name;
+  AssetPackEntry entry{};
+  std::vector<uint8_t> data;
+};
+
+bool read_file(const fs::path& path, std::vector<uint8_t>* out) {
+  std::ifstream stream{path, std::ios::binary | std::ios::ate};
+  if (!stream) {
+    return false;
+  }
+
+  auto size = stream.tellg();
+  out->resize(size_t(size));
+  stream.seekg(0);
+  stream.read(reinterpret_cast<char*>(out->data()), size);
+
+  return bool(stream);
+}
+
+bool classify(const fs::path& path, AssetType* type) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+  if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" ||
+      extension == ".bmp") {
+    *type = AssetType::kImage;
+  } else if (extension == ".vert" || extension == ".frag" || extension == ".glsl" ||
+             extension == ".comp" || extension == ".geom") {
+    *type = AssetType::kShader;
+  } else if (extension == ".vtx") {
+    // Raw arrays of `Vertex`.
+    *type = AssetType::kVertices;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+// Appends `image` and all of its box filtered mip levels down to 1x1.
+uint32_t append_mip_chain(const Image& image, bool mips, std::vector<uint8_t>* out) {
+  out->insert(out->end(), image.pixels.begin(), image.pixels.end());
+  if (!mips) {
+    return 1;
+  }
+
+  uint32_t count = 1;
+  Image current = image;
+
+  while (current.width > 1 || current.height > 1) {
+    current = half_size(current);
+    out->insert(out->end(), current.pixels.begin(), current.pixels.end());
+    ++count;
+  }
+
+  return count;
+}
+
+bool cook(const fs::path& path, AssetType type, bool mips, const std::vector<uint8_t>& source,
+          CookedAsset* asset) {
+  asset->entry.type = type;
+
+  if (type != AssetType::kImage) {
+    asset->data = source;
+    return true;
+  }
+
+  Image image;
+  if (!decode_image(source.data(), source.size(), &image)) {
+    std::cerr << "Could not decode " << path.string() << ".\n";
+    return false;
+  }
+  if (uint32_t(image.width) > kAssetPackMaxImageSize ||
+      uint32_t(image.height) > kAssetPackMaxImageSize) {
+    std::cerr << path.string() << " is larger than " << kAssetPackMaxImageSize << " texels.\n";
+    return false;
+  }
+
+  asset->entry.width = uint32_t(image.width);
+  asset->entry.height = uint32_t(image.height);
+  asset->entry.mip_count = append_mip_chain(image, mips, &asset->data);
+
+  return true;
+}
+
+bool write_pack(const fs::path& path, std::vector<CookedAsset>* assets) {
+  std::sort(assets->begin(), assets->end(), [](const CookedAsset& a, const CookedAsset& b) {
+    return a.entry.name_hash < b.entry.name_hash;
+  });
+
+  std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+  if (!stream) {
+    return false;
+  }
+
+  AssetPackHeader header{};
+  header.magic = kAssetPackMagic;
+  header.version = kAssetPackVersion;
+  header.entry_count = uint32_t(assets->size());
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  uint64_t offset = sizeof(header);
+  auto pad_to_alignment = [&stream, &offset]() {
+    static const char zeros[kAssetPackAlignment] = {};
+    size_t padding = (kAssetPackAlignment - offset % kAssetPackAlignment) % kAssetPackAlignment;
+    stream.write(zeros, std::streamsize(padding));
+    offset += padding;
+  };
+
+  for (auto& asset : *assets) {
+    pad_to_alignment();
+    asset.entry.data_offset = offset;
+    asset.entry.data_size = asset.data.size();
+    stream.write(reinterpret_cast<const char*>(asset.data.data()),
+                 std::streamsize(asset.data.size()));
+    offset += asset.data.size();
+  }
+
+  header.strings_offset = offset;
+  uint32_t string_offset = 0;
+  for (auto& asset : *assets) {
+    asset.entry.name_offset = string_offset;
+    asset.entry.name_length = uint32_t(asset.name.size());
+    stream.write(asset.name.data(), std::streamsize(asset.name.size()));
+    string_offset += uint32_t(asset.name.size());
+  }
+  offset += string_offset;
+
+  pad_to_alignment();
+  header.index_offset = offset;
+  for (const auto& asset : *assets) {
+    stream.write(reinterpret_cast<const char*>(&asset.entry), sizeof(AssetPackEntry));
+  }
+
+  stream.seekp(0);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  return bool(stream);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: asset-cooker <resources_dir> <output_pack> [--mips]\n";
+    return 1;
+  }
+
+  fs::path resources_dir = argv[1];
+  fs::path output = argv[2];
+  bool mips = argc > 3 && std::strcmp(argv[3], "--mips") == 0;
+
+  // Assets from the previous pack that can be reused if their source did not change.
+  AssetPack previous;
+  std::unordered_map<std::string_view, const AssetPackEntry*> previous_entries;
+  if (previous.open(output.string())) {
+    for (const auto& entry : previous) {
+      previous_entries.emplace(previous.name(entry), &entry);
+    }
+  }
+
+  std::vector<CookedAsset> assets;
+  size_t cooked = 0;
+  size_t reused = 0;
+  size_t failed = 0;
+
+  std::error_code ec;
+  for (const auto& file : fs::recursive_directory_iterator{resources_dir, ec}) {
+    AssetType type;
+    if (!file.is_regular_file() || !classify(file.path(), &type)) {
+      continue;
+    }
+
+    std::vector<uint8_t> source;
+    if (!read_file(file.path(), &source)) {
+      std::cerr << "Could not read " << file.path().string() << ".\n";
+      ++failed;
+      continue;
+    }
+
+    CookedAsset asset;
+    asset.name = file.path().lexically_relative(resources_dir).generic_string();
+    asset.entry.name_hash = fnv1a_64(asset.name);
+    asset.entry.content_hash = fnv1a_64(source.data(), source.size());
+
+    auto it = previous_entries.find(asset.name);
+    if (it != previous_entries.end()) {
+      const AssetPackEntry& old = *it->second;
+      bool same_mips = type != AssetType::kImage ||
+                       old.mip_count == (mips ? full_mip_count(old.width, old.height) : 1);
+      if (old.content_hash == asset.entry.content_hash && old.type == type && same_mips) {
+        asset.entry = old;
+        const uint8_t* data = previous.data(old);
+        asset.data.assign(data, data + old.data_size);
+        assets.push_back(std::move(asset));
+        ++reused;
+        continue;
+      }
+    }
+
+    if (!cook(file.path(), type, mips, source, &asset)) {
+      ++failed;
+      continue;
+    }
+    assets.push_back(std::move(asset));
+    ++cooked;
+  }
+
+  if (ec) {
+    std::cerr << "Could not read " << resources_dir.string() << ": " << ec.message() << '\n';
+    return 1;
+  }
+
+  if (cooked == 0 && failed == 0 && assets.size() == previous_entries.size()) {
+    std::cout << output.string() << " is up to date.\n";
+    return 0;
+  }
+
+  // Write next to the old pack first; the old pack is still mapped while we copy from it.
+  fs::path temp = output;
+  temp += ".tmp";
+  if (!write_pack(temp, &assets)) {
+    std::cerr << "Could not write " << temp.string() << ".\n";
+    return 1;
+  }
+  previous.close();
+
+  fs::rename(temp, output, ec);
+  if (ec) {
+    std::cerr << "Could not replace " << output.string() << ": " << ec.message() << '\n';
+    return 1;
+  }
+
+  std::cout << "Cooked " << cooked << ", reused " << reused << ", failed " << failed << " -> "
+            << output.string() << '\n';
+
+  return failed == 0 ? 0 : 1;
+}
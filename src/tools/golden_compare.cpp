@@ -0,0 +1,80 @@
+// Compares frames rendered by `core-graphics --headless --output <dir>` against golden images.
+//
+// Every PNG in the golden directory must exist in the frames directory with the same name and
+// size.  A frame fails when more than `max_mismatched` pixels differ by more than `tolerance` in
+// any channel.  Exits with 1 if any frame fails, so it can gate CI.
+//
+// To update the golden images, render with --output pointing at the golden directory.
+//
+// Usage: golden-compare <golden_dir> <frames_dir> [tolerance] [max_mismatched]
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "image.h"
+
+namespace fs = std::filesystem;
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: golden-compare <golden_dir> <frames_dir> [tolerance] [max_mismatched]\n";
+    return 1;
+  }
+
+  fs::path golden_dir = argv[1];
+  fs::path frames_dir = argv[2];
+  int tolerance = argc > 3 ? std::atoi(argv[3]) : 2;
+  size_t max_mismatched = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+
+  std::vector<fs::path> goldens;
+  std::error_code ec;
+  for (const auto& file : fs::directory_iterator{golden_dir, ec}) {
+    if (file.is_regular_file() && file.path().extension() == ".png") {
+      goldens.push_back(file.path());
+    }
+  }
+  std::sort(goldens.begin(), goldens.end());
+
+  if (goldens.empty()) {
+    std::cerr << "No golden images in " << golden_dir.string() << ".\n";
+    return 1;
+  }
+
+  size_t failures = 0;
+  for (const auto& golden_path : goldens) {
+    fs::path frame_path = frames_dir / golden_path.filename();
+    std::string name = golden_path.filename().string();
+
+    Image golden;
+    Image frame;
+    if (!load_image(golden_path.string(), &golden) || !load_image(frame_path.string(), &frame)) {
+      std::cout << "FAIL " << name << ": missing\n";
+      ++failures;
+      continue;
+    }
+
+    ImageDifference difference;
+    if (!compare_images(golden, frame, tolerance, &difference)) {
+      std::cout << "FAIL " << name << ": size " << frame.width << "x" << frame.height
+                << ", expected " << golden.width << "x" << golden.height << '\n';
+      ++failures;
+      continue;
+    }
+
+    bool passed = difference.mismatched_pixels <= max_mismatched;
+    if (!passed) {
+      ++failures;
+    }
+    std::cout << (passed ? "ok   " : "FAIL ") << name << ": " << difference.mismatched_pixels
+              << " pixels differ, max error " << difference.max_error << ", PSNR "
+              << difference.psnr << " dB\n";
+  }
+
+  std::cout << goldens.size() - failures << " of " << goldens.size() << " frames match.\n";
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,46 @@
+// Compresses an image to a DDS file with a BC1, BC3 or BC7 mip chain, so textures can be
+// compressed offline and loaded with `load_compressed_texture`.
+//
+// Usage: texture-compressor <input> <output.dds> [bc1|bc3|bc7] [--no-mips]
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "compressed_image.h"
+#include "image.h"
+#include "texture_compression.h"
+
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: texture-compressor <input> <output.dds> [bc1|bc3|bc7] [--no-mips]\n";
+    return 1;
+  }
+
+  BlockFormat format = BlockFormat::kBC7;
+  if (argc > 3 && !parse_block_format(argv[3], &format)) {
+    std::cerr << "Unknown format " << argv[3] << ".\n";
+    return 1;
+  }
+  bool mips = !(argc > 4 && std::strcmp(argv[4], "--no-mips") == 0);
+
+  Image image;
+  if (!load_image(argv[1], &image)) {
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  CompressedImage compressed;
+  compress_image(image, format, best_encoder_path(), mips, &compressed);
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+  if (!write_dds(argv[2], compressed)) {
+    return 1;
+  }
+
+  std::cout << argv[1] << ": " << image.width << "x" << image.height << " "
+            << block_format_name(format) << ", " << compressed.levels.size() << " levels, "
+            << compressed.data.size() << " bytes in " << elapsed.count() << " ms.\n";
+
+  return 0;
+}
@@ -0,0 +1,626 @@
+#include "transform_stage.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CORE_GRAPHICS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// AVX kernels are compiled for AVX regardless of the global flags and only called after checking
+// the CPU at runtime.
+#if defined(CORE_GRAPHICS_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CORE_GRAPHICS_TARGET_AVX __attribute__((target("avx")))
+#else
+#define CORE_GRAPHICS_TARGET_AVX
+#endif
+
+namespace {
+
+#if defined(CORE_GRAPHICS_X86)
+
+int count_trailing_zeros(unsigned mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return int(index);
+#else
+  return __builtin_ctz(mask);
+#endif
+}
+
+size_t append_mask(unsigned mask, size_t base, uint32_t* out) {
+  size_t count = 0;
+  while (mask) {
+    out[count++] = uint32_t(base + size_t(count_trailing_zeros(mask)));
+    mask &= mask - 1;
+  }
+  return count;
+}
+
+__m128 abs_ps(__m128 v) {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+// Transposes one matrix column for 4 objects (x, y, z, w hold the component for each object) and
+// stores it into the 4 consecutive matrices at `matrices`.
+void store_column(__m128 x, __m128 y, __m128 z, __m128 w, int column, glm::mat4* matrices) {
+  _MM_TRANSPOSE4_PS(x, y, z, w);
+  _mm_storeu_ps(&matrices[0][column][0], x);
+  _mm_storeu_ps(&matrices[1][column][0], y);
+  _mm_storeu_ps(&matrices[2][column][0], z);
+  _mm_storeu_ps(&matrices[3][column][0], w);
+}
+
+#endif
+
+}  // namespace
+
+SimdPath best_simd_path() {
+#if defined(CORE_GRAPHICS_X86)
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+  if ((info[2] & (1 << 28)) && os_saves_ymm) {
+    return SimdPath::kAvx;
+  }
+  return SimdPath::kSse;
+#else
+  if (__builtin_cpu_supports("avx")) {
+    return SimdPath::kAvx;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdPath::kSse;
+  }
+#endif
+#endif
+  return SimdPath::kScalar;
+}
+
+const char* simd_path_name(SimdPath path) {
+  switch (path) {
+    case SimdPath::kScalar:
+      return "scalar";
+    case SimdPath::kSse:
+      return "sse";
+    case SimdPath::kAvx:
+      return "avx";
+  }
+  return "unknown";
+}
+
+Frustum extract_frustum(const glm::mat4& m) {
+  auto row = [&m](int i) {
+    return glm::vec4{m[0][i], m[1][i], m[2][i], m[3][i]};
+  };
+
+  Frustum frustum;
+  frustum.planes[0] = row(3) + row(0);
+  frustum.planes[1] = row(3) - row(0);
+  frustum.planes[2] = row(3) + row(1);
+  frustum.planes[3] = row(3) - row(1);
+  frustum.planes[4] = row(3) + row(2);
+  frustum.planes[5] = row(3) - row(2);
+
+  for (auto& plane : frustum.planes) {
+    plane /= glm::length(glm::vec3{plane});
+  }
+
+  return frustum;
+}
+
+uint32_t TransformStage::add(const glm::vec3& position, const glm::quat& rotation,
+                             const glm::vec3& scale, const glm::vec3& half_extents) {
+  auto index = uint32_t(size());
+
+  position_x_.push_back(position.x);
+  position_y_.push_back(position.y);
+  position_z_.push_back(position.z);
+  rotation_x_.push_back(rotation.x);
+  rotation_y_.push_back(rotation.y);
+  rotation_z_.push_back(rotation.z);
+  rotation_w_.push_back(rotation.w);
+  scale_x_.push_back(scale.x);
+  scale_y_.push_back(scale.y);
+  scale_z_.push_back(scale.z);
+  half_x_.push_back(half_extents.x);
+  half_y_.push_back(half_extents.y);
+  half_z_.push_back(half_extents.z);
+
+  world_.emplace_back(1.0f);
+  radius_.push_back(0.0f);
+  extent_x_.push_back(0.0f);
+  extent_y_.push_back(0.0f);
+  extent_z_.push_back(0.0f);
+
+  return index;
+}
+
+void TransformStage::set_position(uint32_t index, const glm::vec3& position) {
+  position_x_[index] = position.x;
+  position_y_[index] = position.y;
+  position_z_[index] = position.z;
+}
+
+void TransformStage::set_rotation(uint32_t index, const glm::quat& rotation) {
+  rotation_x_[index] = rotation.x;
+  rotation_y_[index] = rotation.y;
+  rotation_z_[index] = rotation.z;
+  rotation_w_[index] = rotation.w;
+}
+
+void TransformStage::reserve(size_t count) {
+  for (auto* v : {&position_x_, &position_y_, &position_z_, &rotation_x_, &rotation_y_,
+                  &rotation_z_, &rotation_w_, &scale_x_, &scale_y_, &scale_z_, &half_x_, &half_y_,
+                  &half_z_, &radius_, &extent_x_, &extent_y_, &extent_z_}) {
+    v->reserve(count);
+  }
+  world_.reserve(count);
+}
+
+void TransformStage::clear() {
+  for (auto* v : {&position_x_, &position_y_, &position_z_, &rotation_x_, &rotation_y_,
+                  &rotation_z_, &rotation_w_, &scale_x_, &scale_y_, &scale_z_, &half_x_, &half_y_,
+                  &half_z_, &radius_, &extent_x_, &extent_y_, &extent_z_}) {
+    v->clear();
+  }
+  world_.clear();
+}
+
+void TransformStage::update(SimdPath path) {
+  update(path, 0, size());
+}
+
+void TransformStage::cull_spheres(const Frustum& frustum, SimdPath path,
+                                  std::vector<uint32_t>* visible) const {
+  cull_spheres(frustum, path, 0, size(), visible);
+}
+
+void TransformStage::cull_boxes(const Frustum& frustum, SimdPath path,
+                                std::vector<uint32_t>* visible) const {
+  cull_boxes(frustum, path, 0, size(), visible);
+}
+
+void TransformStage::update(SimdPath path, size_t first, size_t last) {
+  size_t simd_end = first;
+
+  if (path == SimdPath::kAvx) {
+    simd_end = first + ((last - first) & ~size_t(7));
+    update_avx(first, simd_end);
+  } else if (path == SimdPath::kSse) {
+    simd_end = first + ((last - first) & ~size_t(3));
+    update_sse(first, simd_end);
+  }
+
+  update_scalar(simd_end, last);
+}
+
+void TransformStage::cull_spheres(const Frustum& frustum, SimdPath path, size_t first,
+                                  size_t last, std::vector<uint32_t>* visible) const {
+  visible->resize(last - first);
+
+  size_t simd_end = first;
+  size_t written = 0;
+  if (path == SimdPath::kAvx) {
+    simd_end = first + ((last - first) & ~size_t(7));
+    written = cull_spheres_avx(frustum, first, simd_end, visible->data());
+  } else if (path == SimdPath::kSse) {
+    simd_end = first + ((last - first) & ~size_t(3));
+    written = cull_spheres_sse(frustum, first, simd_end, visible->data());
+  }
+  written += cull_spheres_scalar(frustum, simd_end, last, visible->data() + written);
+
+  visible->resize(written);
+}
+
+void TransformStage::cull_boxes(const Frustum& frustum, SimdPath path, size_t first, size_t last,
+                                std::vector<uint32_t>* visible) const {
+  visible->resize(last - first);
+
+  size_t simd_end = first;
+  size_t written = 0;
+  if (path == SimdPath::kAvx) {
+    simd_end = first + ((last - first) & ~size_t(7));
+    written = cull_boxes_avx(frustum, first, simd_end, visible->data());
+  } else if (path == SimdPath::kSse) {
+    simd_end = first + ((last - first) & ~size_t(3));
+    written = cull_boxes_sse(frustum, first, simd_end, visible->data());
+  }
+  written += cull_boxes_scalar(frustum, simd_end, last, visible->data() + written);
+
+  visible->resize(written);
+}
+
+// Scalar ----------------------------------------------------------------------------------------
+
+void TransformStage::update_scalar(size_t first, size_t last) {
+  for (size_t i = first; i < last; ++i) {
+    glm::quat rotation{rotation_w_[i], rotation_x_[i], rotation_y_[i], rotation_z_[i]};
+    glm::mat4 m = glm::mat4_cast(rotation);
+    m[0] *= scale_x_[i];
+    m[1] *= scale_y_[i];
+    m[2] *= scale_z_[i];
+    m[3] = glm::vec4{position_x_[i], position_y_[i], position_z_[i], 1.0f};
+    world_[i] = m;
+
+    extent_x_[i] = std::abs(m[0][0]) * half_x_[i] + std::abs(m[1][0]) * half_y_[i] +
+                   std::abs(m[2][0]) * half_z_[i];
+    extent_y_[i] = std::abs(m[0][1]) * half_x_[i] + std::abs(m[1][1]) * half_y_[i] +
+                   std::abs(m[2][1]) * half_z_[i];
+    extent_z_[i] = std::abs(m[0][2]) * half_x_[i] + std::abs(m[1][2]) * half_y_[i] +
+                   std::abs(m[2][2]) * half_z_[i];
+
+    float max_scale =
+        std::max({std::abs(scale_x_[i]), std::abs(scale_y_[i]), std::abs(scale_z_[i])});
+    radius_[i] = std::sqrt(half_x_[i] * half_x_[i] + half_y_[i] * half_y_[i] +
+                           half_z_[i] * half_z_[i]) *
+                 max_scale;
+  }
+}
+
+size_t TransformStage::cull_spheres_scalar(const Frustum& frustum, size_t first, size_t last,
+                                           uint32_t* out) const {
+  size_t count = 0;
+  for (size_t i = first; i < last; ++i) {
+    bool inside = true;
+    for (const auto& plane : frustum.planes) {
+      float distance = plane.x * position_x_[i] + plane.y * position_y_[i] +
+                       plane.z * position_z_[i] + plane.w;
+      inside &= distance >= -radius_[i];
+    }
+    if (inside) {
+      out[count++] = uint32_t(i);
+    }
+  }
+  return count;
+}
+
+size_t TransformStage::cull_boxes_scalar(const Frustum& frustum, size_t first, size_t last,
+                                         uint32_t* out) const {
+  size_t count = 0;
+  for (size_t i = first; i < last; ++i) {
+    bool inside = true;
+    for (const auto& plane : frustum.planes) {
+      float distance = plane.x * position_x_[i] + plane.y * position_y_[i] +
+                       plane.z * position_z_[i] + plane.w;
+      float radius = std::abs(plane.x) * extent_x_[i] + std::abs(plane.y) * extent_y_[i] +
+                     std::abs(plane.z) * extent_z_[i];
+      inside &= distance >= -radius;
+    }
+    if (inside) {
+      out[count++] = uint32_t(i);
+    }
+  }
+  return count;
+}
+
+#if defined(CORE_GRAPHICS_X86)
+
+// SSE -------------------------------------------------------------------------------------------
+
+void TransformStage::update_sse(size_t first, size_t last) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 zero = _mm_setzero_ps();
+
+  for (size_t i = first; i < last; i += 4) {
+    __m128 px = _mm_loadu_ps(&position_x_[i]);
+    __m128 py = _mm_loadu_ps(&position_y_[i]);
+    __m128 pz = _mm_loadu_ps(&position_z_[i]);
+    __m128 qx = _mm_loadu_ps(&rotation_x_[i]);
+    __m128 qy = _mm_loadu_ps(&rotation_y_[i]);
+    __m128 qz = _mm_loadu_ps(&rotation_z_[i]);
+    __m128 qw = _mm_loadu_ps(&rotation_w_[i]);
+    __m128 sx = _mm_loadu_ps(&scale_x_[i]);
+    __m128 sy = _mm_loadu_ps(&scale_y_[i]);
+    __m128 sz = _mm_loadu_ps(&scale_z_[i]);
+    __m128 hx = _mm_loadu_ps(&half_x_[i]);
+    __m128 hy = _mm_loadu_ps(&half_y_[i]);
+    __m128 hz = _mm_loadu_ps(&half_z_[i]);
+
+    __m128 xx = _mm_mul_ps(qx, qx);
+    __m128 yy = _mm_mul_ps(qy, qy);
+    __m128 zz = _mm_mul_ps(qz, qz);
+    __m128 xy = _mm_mul_ps(qx, qy);
+    __m128 xz = _mm_mul_ps(qx, qz);
+    __m128 yz = _mm_mul_ps(qy, qz);
+    __m128 wx = _mm_mul_ps(qw, qx);
+    __m128 wy = _mm_mul_ps(qw, qy);
+    __m128 wz = _mm_mul_ps(qw, qz);
+
+    // Rotation times scale; mRC is row R, column C.
+    __m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    __m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    __m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    __m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    __m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    __m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    __m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    __m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    __m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+    glm::mat4* matrices = &world_[i];
+    store_column(m00, m10, m20, zero, 0, matrices);
+    store_column(m01, m11, m21, zero, 1, matrices);
+    store_column(m02, m12, m22, zero, 2, matrices);
+    store_column(px, py, pz, one, 3, matrices);
+
+    __m128 ex = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_ps(m00), hx), _mm_mul_ps(abs_ps(m01), hy)),
+                           _mm_mul_ps(abs_ps(m02), hz));
+    __m128 ey = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_ps(m10), hx), _mm_mul_ps(abs_ps(m11), hy)),
+                           _mm_mul_ps(abs_ps(m12), hz));
+    __m128 ez = _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_ps(m20), hx), _mm_mul_ps(abs_ps(m21), hy)),
+                           _mm_mul_ps(abs_ps(m22), hz));
+    _mm_storeu_ps(&extent_x_[i], ex);
+    _mm_storeu_ps(&extent_y_[i], ey);
+    _mm_storeu_ps(&extent_z_[i], ez);
+
+    __m128 max_scale = _mm_max_ps(_mm_max_ps(abs_ps(sx), abs_ps(sy)), abs_ps(sz));
+    __m128 length = _mm_sqrt_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(hx, hx), _mm_mul_ps(hy, hy)), _mm_mul_ps(hz, hz)));
+    _mm_storeu_ps(&radius_[i], _mm_mul_ps(length, max_scale));
+  }
+}
+
+size_t TransformStage::cull_spheres_sse(const Frustum& frustum, size_t first, size_t last,
+                                        uint32_t* out) const {
+  __m128 nx[6], ny[6], nz[6], nw[6];
+  for (int p = 0; p < 6; ++p) {
+    nx[p] = _mm_set1_ps(frustum.planes[p].x);
+    ny[p] = _mm_set1_ps(frustum.planes[p].y);
+    nz[p] = _mm_set1_ps(frustum.planes[p].z);
+    nw[p] = _mm_set1_ps(frustum.planes[p].w);
+  }
+
+  size_t count = 0;
+  for (size_t i = first; i < last; i += 4) {
+    __m128 px = _mm_loadu_ps(&position_x_[i]);
+    __m128 py = _mm_loadu_ps(&position_y_[i]);
+    __m128 pz = _mm_loadu_ps(&position_z_[i]);
+    __m128 negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&radius_[i]));
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(nx[p], px), _mm_mul_ps(ny[p], py)),
+          _mm_add_ps(_mm_mul_ps(nz[p], pz), nw[p]));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+    }
+
+    count += append_mask(unsigned(_mm_movemask_ps(inside)), i, out + count);
+  }
+  return count;
+}
+
+size_t TransformStage::cull_boxes_sse(const Frustum& frustum, size_t first, size_t last,
+                                      uint32_t* out) const {
+  __m128 nx[6], ny[6], nz[6], nw[6];
+  __m128 ax[6], ay[6], az[6];
+  for (int p = 0; p < 6; ++p) {
+    nx[p] = _mm_set1_ps(frustum.planes[p].x);
+    ny[p] = _mm_set1_ps(frustum.planes[p].y);
+    nz[p] = _mm_set1_ps(frustum.planes[p].z);
+    nw[p] = _mm_set1_ps(frustum.planes[p].w);
+    ax[p] = abs_ps(nx[p]);
+    ay[p] = abs_ps(ny[p]);
+    az[p] = abs_ps(nz[p]);
+  }
+
+  size_t count = 0;
+  for (size_t i = first; i < last; i += 4) {
+    __m128 px = _mm_loadu_ps(&position_x_[i]);
+    __m128 py = _mm_loadu_ps(&position_y_[i]);
+    __m128 pz = _mm_loadu_ps(&position_z_[i]);
+    __m128 ex = _mm_loadu_ps(&extent_x_[i]);
+    __m128 ey = _mm_loadu_ps(&extent_y_[i]);
+    __m128 ez = _mm_loadu_ps(&extent_z_[i]);
+
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(nx[p], px), _mm_mul_ps(ny[p], py)),
+          _mm_add_ps(_mm_mul_ps(nz[p], pz), nw[p]));
+      __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], ex), _mm_mul_ps(ay[p], ey)),
+                                 _mm_mul_ps(az[p], ez));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+    }
+
+    count += append_mask(unsigned(_mm_movemask_ps(inside)), i, out + count);
+  }
+  return count;
+}
+
+// AVX -------------------------------------------------------------------------------------------
+
+namespace {
+
+CORE_GRAPHICS_TARGET_AVX __m256 abs_ps(__m256 v) {
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+CORE_GRAPHICS_TARGET_AVX void store_column(__m256 x, __m256 y, __m256 z, __m256 w, int column,
+                                           glm::mat4* matrices) {
+  store_column(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z),
+               _mm256_castps256_ps128(w), column, matrices);
+  store_column(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1),
+               _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1), column, matrices + 4);
+}
+
+}  // namespace
+
+CORE_GRAPHICS_TARGET_AVX void TransformStage::update_avx(size_t first, size_t last) {
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 two = _mm256_set1_ps(2.0f);
+  const __m256 zero = _mm256_setzero_ps();
+
+  for (size_t i = first; i < last; i += 8) {
+    __m256 px = _mm256_loadu_ps(&position_x_[i]);
+    __m256 py = _mm256_loadu_ps(&position_y_[i]);
+    __m256 pz = _mm256_loadu_ps(&position_z_[i]);
+    __m256 qx = _mm256_loadu_ps(&rotation_x_[i]);
+    __m256 qy = _mm256_loadu_ps(&rotation_y_[i]);
+    __m256 qz = _mm256_loadu_ps(&rotation_z_[i]);
+    __m256 qw = _mm256_loadu_ps(&rotation_w_[i]);
+    __m256 sx = _mm256_loadu_ps(&scale_x_[i]);
+    __m256 sy = _mm256_loadu_ps(&scale_y_[i]);
+    __m256 sz = _mm256_loadu_ps(&scale_z_[i]);
+    __m256 hx = _mm256_loadu_ps(&half_x_[i]);
+    __m256 hy = _mm256_loadu_ps(&half_y_[i]);
+    __m256 hz = _mm256_loadu_ps(&half_z_[i]);
+
+    __m256 xx = _mm256_mul_ps(qx, qx);
+    __m256 yy = _mm256_mul_ps(qy, qy);
+    __m256 zz = _mm256_mul_ps(qz, qz);
+    __m256 xy = _mm256_mul_ps(qx, qy);
+    __m256 xz = _mm256_mul_ps(qx, qz);
+    __m256 yz = _mm256_mul_ps(qy, qz);
+    __m256 wx = _mm256_mul_ps(qw, qx);
+    __m256 wy = _mm256_mul_ps(qw, qy);
+    __m256 wz = _mm256_mul_ps(qw, qz);
+
+    __m256 m00 = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx);
+    __m256 m10 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+    __m256 m20 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+    __m256 m01 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+    __m256 m11 = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy);
+    __m256 m21 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+    __m256 m02 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+    __m256 m12 = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+    __m256 m22 = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz);
+
+    glm::mat4* matrices = &world_[i];
+    store_column(m00, m10, m20, zero, 0, matrices);
+    store_column(m01, m11, m21, zero, 1, matrices);
+    store_column(m02, m12, m22, zero, 2, matrices);
+    store_column(px, py, pz, one, 3, matrices);
+
+    __m256 ex = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(abs_ps(m00), hx), _mm256_mul_ps(abs_ps(m01), hy)),
+        _mm256_mul_ps(abs_ps(m02), hz));
+    __m256 ey = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(abs_ps(m10), hx), _mm256_mul_ps(abs_ps(m11), hy)),
+        _mm256_mul_ps(abs_ps(m12), hz));
+    __m256 ez = _mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(abs_ps(m20), hx), _mm256_mul_ps(abs_ps(m21), hy)),
+        _mm256_mul_ps(abs_ps(m22), hz));
+    _mm256_storeu_ps(&extent_x_[i], ex);
+    _mm256_storeu_ps(&extent_y_[i], ey);
+    _mm256_storeu_ps(&extent_z_[i], ez);
+
+    __m256 max_scale = _mm256_max_ps(_mm256_max_ps(abs_ps(sx), abs_ps(sy)), abs_ps(sz));
+    __m256 length = _mm256_sqrt_ps(_mm256_add_ps(
+        _mm256_add_ps(_mm256_mul_ps(hx, hx), _mm256_mul_ps(hy, hy)), _mm256_mul_ps(hz, hz)));
+    _mm256_storeu_ps(&radius_[i], _mm256_mul_ps(length, max_scale));
+  }
+}
+
+CORE_GRAPHICS_TARGET_AVX size_t TransformStage::cull_spheres_avx(const Frustum& frustum,
+                                                                 size_t first, size_t last,
+                                                                 uint32_t* out) const {
+  __m256 nx[6], ny[6], nz[6], nw[6];
+  for (int p = 0; p < 6; ++p) {
+    nx[p] = _mm256_set1_ps(frustum.planes[p].x);
+    ny[p] = _mm256_set1_ps(frustum.planes[p].y);
+    nz[p] = _mm256_set1_ps(frustum.planes[p].z);
+    nw[p] = _mm256_set1_ps(frustum.planes[p].w);
+  }
+
+  size_t count = 0;
+  for (size_t i = first; i < last; i += 8) {
+    __m256 px = _mm256_loadu_ps(&position_x_[i]);
+    __m256 py = _mm256_loadu_ps(&position_y_[i]);
+    __m256 pz = _mm256_loadu_ps(&position_z_[i]);
+    __m256 negative_radius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&radius_[i]));
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+      __m256 distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(nx[p], px), _mm256_mul_ps(ny[p], py)),
+          _mm256_add_ps(_mm256_mul_ps(nz[p], pz), nw[p]));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+    }
+
+    count += append_mask(unsigned(_mm256_movemask_ps(inside)), i, out + count);
+  }
+  return count;
+}
+
+CORE_GRAPHICS_TARGET_AVX size_t TransformStage::cull_boxes_avx(const Frustum& frustum,
+                                                               size_t first, size_t last,
+                                                               uint32_t* out) const {
+  __m256 nx[6], ny[6], nz[6], nw[6];
+  __m256 ax[6], ay[6], az[6];
+  for (int p = 0; p < 6; ++p) {
+    nx[p] = _mm256_set1_ps(frustum.planes[p].x);
+    ny[p] = _mm256_set1_ps(frustum.planes[p].y);
+    nz[p] = _mm256_set1_ps(frustum.planes[p].z);
+    nw[p] = _mm256_set1_ps(frustum.planes[p].w);
+    ax[p] = abs_ps(nx[p]);
+    ay[p] = abs_ps(ny[p]);
+    az[p] = abs_ps(nz[p]);
+  }
+
+  size_t count = 0;
+  for (size_t i = first; i < last; i += 8) {
+    __m256 px = _mm256_loadu_ps(&position_x_[i]);
+    __m256 py = _mm256_loadu_ps(&position_y_[i]);
+    __m256 pz = _mm256_loadu_ps(&position_z_[i]);
+    __m256 ex = _mm256_loadu_ps(&extent_x_[i]);
+    __m256 ey = _mm256_loadu_ps(&extent_y_[i]);
+    __m256 ez = _mm256_loadu_ps(&extent_z_[i]);
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; ++p) {
+      __m256 distance = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(nx[p], px), _mm256_mul_ps(ny[p], py)),
+          _mm256_add_ps(_mm256_mul_ps(nz[p], pz), nw[p]));
+      __m256 radius = _mm256_add_ps(
+          _mm256_add_ps(_mm256_mul_ps(ax[p], ex), _mm256_mul_ps(ay[p], ey)),
+          _mm256_mul_ps(az[p], ez));
+      inside = _mm256_and_ps(
+          inside, _mm256_cmp_ps(distance, _mm256_sub_ps(_mm256_setzero_ps(), radius), _CMP_GE_OQ));
+    }
+
+    count += append_mask(unsigned(_mm256_movemask_ps(inside)), i, out + count);
+  }
+  return count;
+}
+
+#else
+
+// Without x86 SIMD every path runs the scalar kernels.
+
+void TransformStage::update_sse(size_t first, size_t last) {
+  update_scalar(first, last);
+}
+
+void TransformStage::update_avx(size_t first, size_t last) {
+  update_scalar(first, last);
+}
+
+size_t TransformStage::cull_spheres_sse(const Frustum& frustum, size_t first, size_t last,
+                                        uint32_t* out) const {
+  return cull_spheres_scalar(frustum, first, last, out);
+}
+
+size_t TransformStage::cull_spheres_avx(const Frustum& frustum, size_t first, size_t last,
+                                        uint32_t* out) const {
+  return cull_spheres_scalar(frustum, first, last, out);
+}
+
+size_t TransformStage::cull_boxes_sse(const Frustum& frustum, size_t first, size_t last,
+                                      uint32_t* out) const {
+  return cull_boxes_scalar(frustum, first, last, out);
+}
+
+size_t TransformStage::cull_boxes_avx(const Frustum& frustum, size_t first, size_t last,
+                                      uint32_t* out) const {
+  return cull_boxes_scalar(frustum, first, last, out);
+}
+
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+enum class SimdPath {
+  kScalar,
+  kSse,
+  kAvx,
+};
+
+// Widest path supported by the CPU we are running on.
+SimdPath best_simd_path();
+
+const char* simd_path_name(SimdPath path);
+
+// Six planes (left, right, bottom, top, near, far) as (normal, distance) with normals pointing
+// inwards and normalized, so dot(normal, p) + distance is the signed distance to the plane.
+struct Frustum {
+  glm::vec4 planes[6];
+};
+
+Frustum extract_frustum(const glm::mat4& view_projection);
+
+// Transforms and visibility for many objects.  Independent of OpenGL.
+//
+// Object state is stored as a structure of arrays so the SIMD kernels can process 4 (SSE) or 8
+// (AVX) objects per iteration.  Every object is described by a position, rotation, scale and the
+// half extents of its local bounding box, centered on the origin.  `update` computes world
+// matrices plus world space bounding spheres and boxes; `cull_*` then test those against a frustum
+// and write the indices of visible objects into a compact list.
+class TransformStage {
+public:
+  uint32_t add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale,
+               const glm::vec3& half_extents);
+
+  void set_position(uint32_t index, const glm::vec3& position);
+  void set_rotation(uint32_t index, const glm::quat& rotation);
+
+  void reserve(size_t count);
+  void clear();
+
+  size_t size() const {
+    return position_x_.size();
+  }
+
+  void update(SimdPath path);
+
+  void cull_spheres(const Frustum& frustum, SimdPath path, std::vector<uint32_t>* visible) const;
+  void cull_boxes(const Frustum& frustum, SimdPath path, std::vector<uint32_t>* visible) const;
+
+  // The same for the objects in [first, last) only, so disjoint ranges can be processed on
+  // different threads.  Visible indices are still absolute.
+  void update(SimdPath path, size_t first, size_t last);
+
+  void cull_spheres(const Frustum& frustum, SimdPath path, size_t first, size_t last,
+                    std::vector<uint32_t>* visible) const;
+  void cull_boxes(const Frustum& frustum, SimdPath path, size_t first, size_t last,
+                  std::vector<uint32_t>* visible) const;
+
+  // Valid after `update`, one per object.
+  const glm::mat4* world_matrices() const {
+    return world_.data();
+  }
+
+private:
+  void update_scalar(size_t first, size_t last);
+  void update_sse(size_t first, size_t last);
+  void update_avx(size_t first, size_t last);
+
+  // The culling kernels write visible indices to `out` and return how many they wrote.
+  size_t cull_spheres_scalar(const Frustum& frustum, size_t first, size_t last,
+                             uint32_t* out) const;
+  size_t cull_spheres_sse(const Frustum& frustum, size_t first, size_t last, uint32_t* out) const;
+  size_t cull_spheres_avx(const Frustum& frustum, size_t first, size_t last, uint32_t* out) const;
+
+  size_t cull_boxes_scalar(const Frustum& frustum, size_t first, size_t last,
+                           uint32_t* out) const;
+  size_t cull_boxes_sse(const Frustum& frustum, size_t first, size_t last, uint32_t* out) const;
+  size_t cull_boxes_avx(const Frustum& frustum, size_t first, size_t last, uint32_t* out) const;
+
+  // Inputs.
+  std::vector<float> position_x_, position_y_, position_z_;
+  std::vector<float> rotation_x_, rotation_y_, rotation_z_, rotation_w_;
+  std::vector<float> scale_x_, scale_y_, scale_z_;
+  std::vector<float> half_x_, half_y_, half_z_;
+
+  // Outputs of `update`.  The bounds are centered on the object position.
+  std::vector<glm::mat4> world_;
+  std::vector<float> radius_;
+  std::vector<float> extent_x_, extent_y_, extent_z_;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Vertex layout shared by meshes and the batch renderer. Matches the attribute locations in the
+// default shaders: 0 = position, 1 = color, 2 = tex_coords.
+struct Vertex {
+  glm::vec3 position;
+  glm::vec4 color;
+  glm::vec2 tex_coords;
+};